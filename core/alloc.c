@@ -30,6 +30,9 @@
  * alloc.c: Memory allocation wrappers.  See comments in alloc.h for details.
  */
 
+#include <stdint.h>
+#include <sys/mman.h>
+
 #include "mosys/alloc.h"
 #include "mosys/log.h"
 
@@ -116,3 +119,152 @@ internal_mosys_strdup(const char *str,
 
 	return alloc_fail_abort(strlen(str)+1, file, line, func); // COV_NF_END
 }
+
+#define ARENA_CHUNK_SIZE	(64 * 1024)
+#define ARENA_ALIGN		16
+/* allocations larger than this get a chunk of their own */
+#define ARENA_LARGE		(ARENA_CHUNK_SIZE / 4)
+
+struct arena_chunk {
+	struct arena_chunk *next;
+	size_t size;			/* usable bytes in data */
+	size_t used;
+	int mapped;			/* from mmap() rather than malloc() */
+	unsigned char data[] __attribute__((aligned(ARENA_ALIGN)));
+};
+
+struct mosys_arena {
+	struct arena_chunk *chunks;	/* the one to carve from first */
+	struct mosys_arena_stats stats;
+};
+
+static struct arena_chunk *
+arena_chunk_new(size_t size, const char *file, int line, const char *func)
+{
+	size_t total = sizeof(struct arena_chunk) + size;
+	struct arena_chunk *chunk;
+
+	if (size < ARENA_MMAP_THRESHOLD) {
+		chunk = internal_mosys_malloc(total, file, line, func);
+		chunk->mapped = 0;
+	} else {
+		do {
+			chunk = mmap(NULL, total, PROT_READ | PROT_WRITE,
+				     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		} while (chunk == MAP_FAILED && do_alloc_failure
+		     && (do_alloc_failure(total, file, line, func) == 0));
+
+		if (chunk == MAP_FAILED)
+			return alloc_fail_abort(total, file, line, func);
+		chunk->mapped = 1;
+	}
+
+	chunk->size = size;
+	chunk->used = 0;
+	return chunk;
+}
+
+static void
+arena_chunk_free(struct arena_chunk *chunk)
+{
+	if (chunk->mapped)
+		munmap(chunk, sizeof(*chunk) + chunk->size);
+	else
+		free(chunk);
+}
+
+struct mosys_arena *
+mosys_arena_new(void)
+{
+	return mosys_zalloc(sizeof(struct mosys_arena));
+}
+
+void
+mosys_arena_free(struct mosys_arena *arena)
+{
+	if (!arena)
+		return;
+
+	mosys_arena_release(arena);
+	if (arena->chunks)
+		arena_chunk_free(arena->chunks);
+	free(arena);
+}
+
+void
+mosys_arena_release(struct mosys_arena *arena)
+{
+	struct arena_chunk *chunk, *next, *keep = NULL;
+
+	if (!arena)
+		return;
+
+	for (chunk = arena->chunks; chunk; chunk = next) {
+		next = chunk->next;
+		if (!keep && chunk->size == ARENA_CHUNK_SIZE) {
+			keep = chunk;
+			continue;
+		}
+		arena_chunk_free(chunk);
+	}
+
+	if (keep) {
+		keep->next = NULL;
+		keep->used = 0;
+	}
+	arena->chunks = keep;
+	arena->stats.bytes = 0;
+	arena->stats.peak_bytes = 0;
+}
+
+void
+mosys_arena_stats(const struct mosys_arena *arena,
+		  struct mosys_arena_stats *stats)
+{
+	if (arena)
+		*stats = arena->stats;
+	else
+		memset(stats, 0, sizeof(*stats));
+}
+
+void *
+internal_mosys_arena_alloc(struct mosys_arena *arena, size_t size,
+                          const char *file, int line, const char *func)
+{
+	struct arena_chunk *chunk = arena->chunks;
+	void *p;
+
+	if (size > SIZE_MAX - sizeof(*chunk) - ARENA_ALIGN)
+		return alloc_fail_abort(size, file, line, func);
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+	if (!chunk || chunk->size - chunk->used < size) {
+		if (size > ARENA_LARGE) {
+			/* keep carving small allocations from the current chunk */
+			chunk = arena_chunk_new(size, file, line, func);
+			if (arena->chunks) {
+				chunk->next = arena->chunks->next;
+				arena->chunks->next = chunk;
+			} else {
+				chunk->next = NULL;
+				arena->chunks = chunk;
+			}
+		} else {
+			chunk = arena_chunk_new(ARENA_CHUNK_SIZE, file, line,
+						func);
+			chunk->next = arena->chunks;
+			arena->chunks = chunk;
+		}
+	}
+
+	p = chunk->data + chunk->used;
+	chunk->used += size;
+
+	arena->stats.bytes += size;
+	if (arena->stats.bytes > arena->stats.peak_bytes)
+		arena->stats.peak_bytes = arena->stats.bytes;
+	arena->stats.total_bytes += size;
+	arena->stats.allocations++;
+
+	return p;
+}
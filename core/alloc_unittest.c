@@ -0,0 +1,97 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// cmocka doesn't include some headers it uses, e.g. setjmp. Prevent
+// clang-format from putting the headers in order, so it gets the above
+// includes.
+// clang-format off
+#include <cmocka.h>
+// clang-format on
+
+#include "mosys/alloc.h"
+
+static void arena_allocations_are_aligned(void **state)
+{
+	struct mosys_arena *arena = mosys_arena_new();
+	char *a, *b;
+
+	a = mosys_arena_alloc(arena, 3);
+	b = mosys_arena_alloc(arena, 1);
+	assert_int_equal((uintptr_t)a % 16, 0);
+	assert_int_equal((uintptr_t)b % 16, 0);
+	assert_ptr_equal(b, a + 16);
+
+	mosys_arena_free(arena);
+}
+
+static void arena_large_blocks_do_not_break_chunks(void **state)
+{
+	struct mosys_arena *arena = mosys_arena_new();
+	char *a, *big, *mapped, *b;
+
+	a = mosys_arena_alloc(arena, 16);
+	big = mosys_arena_alloc(arena, 64 * 1024);
+	mapped = mosys_arena_alloc(arena, ARENA_MMAP_THRESHOLD);
+	b = mosys_arena_alloc(arena, 16);
+
+	memset(big, 0xaa, 64 * 1024);
+	memset(mapped, 0x55, ARENA_MMAP_THRESHOLD);
+	assert_ptr_equal(b, a + 16);
+
+	mosys_arena_free(arena);
+}
+
+static void arena_release_reuses_memory(void **state)
+{
+	struct mosys_arena *arena = mosys_arena_new();
+	struct mosys_arena_stats stats;
+	char *a;
+	int i;
+
+	a = mosys_arena_alloc(arena, 100);
+	for (i = 0; i < 1000; i++)
+		mosys_arena_alloc(arena, 100);
+	mosys_arena_alloc(arena, ARENA_MMAP_THRESHOLD);
+
+	mosys_arena_stats(arena, &stats);
+	assert_int_equal(stats.bytes, 1001 * 112 + ARENA_MMAP_THRESHOLD);
+	assert_int_equal(stats.peak_bytes, stats.bytes);
+	assert_int_equal(stats.allocations, 1002);
+
+	mosys_arena_release(arena);
+	mosys_arena_stats(arena, &stats);
+	assert_int_equal(stats.bytes, 0);
+	assert_int_equal(stats.peak_bytes, 0);
+
+	/* one chunk is kept, so the next command does not allocate */
+	a = mosys_arena_alloc(arena, 100);
+	assert_non_null(a);
+	mosys_arena_stats(arena, &stats);
+	assert_int_equal(stats.bytes, 112);
+	assert_int_equal(stats.peak_bytes, 112);
+	assert_int_equal(stats.total_bytes,
+			 1002 * 112 + ARENA_MMAP_THRESHOLD);
+
+	mosys_arena_free(arena);
+	mosys_arena_release(NULL);
+	mosys_arena_free(NULL);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(arena_allocations_are_aligned),
+		cmocka_unit_test(arena_large_blocks_do_not_break_chunks),
+		cmocka_unit_test(arena_release_reuses_memory),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -11,23 +11,39 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "mosys/alloc.h"
 #include "mosys/cli.h"
+#include "mosys/context.h"
+#include "mosys/counters.h"
+#include "mosys/daemon.h"
 #include "mosys/globals.h"
 #include "mosys/kv_pair.h"
 #include "mosys/log.h"
+#include "mosys/output.h"
 #include "mosys/platform.h"
+#include "mosys/trace.h"
+
+#include "lib/math.h"
 
 static void usage(void)
 {
-	printf("usage: mosys [options] [commands]\n\n"
+	mosys_printf("usage: mosys [options] [commands]\n\n"
 	       "  Options:\n"
 	       "    -k            print data in key=value format\n"
 	       "    -l            print data in long format\n"
-	       "    -s [key]      print value for single key\n"
+	       "    -j            print data as JSON\n"
+	       "    -C            print data as CBOR\n"
+	       "    -s [key,...]  print values for the given keys\n"
 	       "    -v            verbose (can be used multiple times)\n"
 	       "    -t            display command tree for detected platform\n"
 	       "    -S            print supported platform IDs\n"
 	       "    -p [id]       specify platform id (bypass auto-detection)\n"
+	       "    -P            probe the platform again, ignoring the boot cache\n"
+	       "    -b [file]     run one command per line from file (- for stdin)\n"
+	       "    -D [socket]   serve commands on a Unix socket (daemon mode)\n"
+	       "    -T            print a per-phase timing summary to stderr\n"
+	       "    -J [file]     write a Chrome trace_event JSON file\n"
+	       "    -c            print I/O counters for each command to stderr\n"
 	       "    -h            print this help\n"
 	       "\n");
 }
@@ -39,18 +55,19 @@ static void sub_list(struct platform_cmd *sub)
 	if (!sub)
 		return;
 
-	printf("  Commands:\n");
+	mosys_printf("  Commands:\n");
 	for (_sub = sub->arg.sub; _sub && _sub->name; _sub++) {
 		if (_sub->desc)
-			printf("    %-12s  %s\n", _sub->name, _sub->desc);
+			mosys_printf("    %-12s  %s\n", _sub->name, _sub->desc);
 	}
-	printf("\n");
+	mosys_printf("\n");
 }
 
 static int sub_main(struct platform_intf *intf, struct platform_cmd *sub,
 		    int argc, char **argv)
 {
 	struct platform_cmd *cmd;
+	int rc, trace_id;
 
 	if (!intf || !sub) {
 		errno = ENOSYS;
@@ -72,7 +89,10 @@ static int sub_main(struct platform_intf *intf, struct platform_cmd *sub,
 		}
 
 		/* run command handler */
-		return sub->arg.func(intf, sub, argc, argv);
+		trace_id = trace_begin("cmd", sub->name);
+		rc = sub->arg.func(intf, sub, argc, argv);
+		trace_end(trace_id);
+		return rc;
 
 	case ARG_TYPE_SUB:
 		if (!argc) {
@@ -87,14 +107,11 @@ static int sub_main(struct platform_intf *intf, struct platform_cmd *sub,
 		}
 
 		/* search for matching sub-command */
-		for (cmd = sub->arg.sub; cmd && cmd->name; cmd++) {
-			if (strlen(cmd->name) != strlen(argv[0]))
-				continue;
-			if (strcmp(cmd->name, argv[0]) == 0) {
-				lprintf(LOG_DEBUG, "Subcommand %s (%s)\n",
-					cmd->name, cmd->desc);
-				return sub_main(intf, cmd, argc - 1, argv + 1);
-			}
+		cmd = platform_find_sub_cmd(sub, argv[0]);
+		if (cmd) {
+			lprintf(LOG_DEBUG, "Subcommand %s (%s)\n",
+				cmd->name, cmd->desc);
+			return sub_main(intf, cmd, argc - 1, argv + 1);
 		}
 		break;
 
@@ -124,31 +141,28 @@ static int intf_main(struct platform_intf *intf, int argc, char **argv)
 	if (!argc || !strcmp(argv[0], "help")) {
 		do_list = true;
 		usage();
-		printf("  Commands:\n");
-	}
-
-	/* go through subcommand list for this interface */
-	for (_sub = intf->sub; _sub && *_sub; _sub++) {
-		 sub = *_sub;
-		 if (do_list) {
-			 printf("    %-12s  %s\n", sub->name, sub->desc);
-			 continue;
-		 }
-
-		 /* is this sub-command is the one they asked for? */
-		 if (!strcmp(sub->name, argv[0])) {
-			 lprintf(LOG_DEBUG, "Found command %s (%s)\n",
-				 sub->name, sub->desc);
-			 return sub_main(intf, sub, argc - 1, &(argv[1]));
-		 }
+		mosys_printf("  Commands:\n");
 	}
 
 	if (do_list) {
+		for (_sub = intf->sub; *_sub; _sub++) {
+			sub = *_sub;
+			mosys_printf("    %-12s  %s\n", sub->name, sub->desc);
+		}
+
 		if (!argc)
 			return -1;
 		return 0;
 	}
 
+	/* is there a sub-command for the one they asked for? */
+	sub = platform_find_root_cmd(intf, argv[0]);
+	if (sub) {
+		lprintf(LOG_DEBUG, "Found command %s (%s)\n",
+			sub->name, sub->desc);
+		return sub_main(intf, sub, argc - 1, &(argv[1]));
+	}
+
 	lprintf(LOG_WARNING, "Command not found\n\n");
 	errno = ENOSYS;
 
@@ -157,20 +171,204 @@ static int intf_main(struct platform_intf *intf, int argc, char **argv)
 	return -1;
 }
 
-int mosys_main(int argc, char **argv)
+/*
+ * exit_status  -  convert a command result into a process exit status
+ *
+ * @rc:		return code from intf_main()
+ * @errsv:	errno saved after intf_main() returned
+ */
+static int exit_status(int rc, int errsv)
 {
+	if (rc < 0 && errsv > 0)
+		return errsv;
+	return rc;
+}
+
+/* print machine-readable I/O counters after each command (-c) */
+static bool print_counters;
+
+/*
+ * report_counters  -  report the I/O done and memory used on behalf of a
+ *                     command line
+ *
+ * @argc:	number of command words
+ * @argv:	command words
+ * @start:	command arena statistics from before the command ran
+ */
+static void report_counters(int argc, char **argv,
+			    const struct mosys_arena_stats *start)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	struct mosys_arena_stats cmd_stats, ctx_stats;
+	char label[128] = "";
+	size_t len = 0;
+	int i;
+
+	for (i = 0; i < argc && len < sizeof(label) - 1; i++) {
+		len += snprintf(label + len, sizeof(label) - len, "%s%s",
+				i ? " " : "", argv[i]);
+	}
+
+	counters_report(label, print_counters);
+
+	mosys_arena_stats(ctx->cmd_arena, &cmd_stats);
+	mosys_arena_stats(ctx->arena, &ctx_stats);
+	lprintf(LOG_NOTICE, "Memory for \"%s\": bytes=\"%zu\" "
+		"peak_bytes=\"%zu\" total_bytes=\"%zu\" allocations=\"%zu\" "
+		"context_bytes=\"%zu\"\n", label, cmd_stats.bytes,
+		cmd_stats.peak_bytes,
+		cmd_stats.total_bytes - start->total_bytes,
+		cmd_stats.allocations - start->allocations, ctx_stats.bytes);
+}
+
+int mosys_run_cmd(struct platform_intf *intf, int argc, char **argv)
+{
+	struct platform_cmd *cmd = platform_find_cmd(intf, argc, argv);
+	struct mosys_arena_stats start;
 	int rc, errsv;
+
+	mosys_arena_stats(mosys_ctx_get()->cmd_arena, &start);
+	counters_reset();
+	log_recorder_reset();
+
+	if (cmd)
+		kv_pair_output_begin(cmd->schema, cmd->flags & CMD_FLAG_LIST);
+	errno = 0;
+	rc = intf_main(intf, argc, argv);
+	errsv = errno;
+	if (cmd)
+		kv_pair_output_end();
+	mosys_output_flush();
+	if (rc < 0 && errsv == ENOSYS)
+		lprintf(LOG_ERR, "Command not supported on this platform\n");
+	else if (rc < 0)
+		log_recorder_dump();
+	log_flush();
+
+	report_counters(argc, argv, &start);
+	mosys_arena_release(mosys_ctx_get()->cmd_arena);
+
+	return exit_status(rc, errsv);
+}
+
+#define BATCH_MAX_ARGS	64
+
+/*
+ * batch_main  -  run one command per input line against a single platform
+ *
+ * @intf:	platform interface
+ * @path:	file to read commands from, "-" for stdin
+ *
+ * Each line holds the words of one command, as they would be given on
+ * the command line (e.g. "memory spd print all").  Blank lines and
+ * lines starting with '#' are ignored.  The output of every command is
+ * framed by marker lines so that results can be split apart again:
+ *
+ *   --- begin <n> <command>
+ *   ...
+ *   --- end <n> status=<exit status>
+ *
+ * returns 0 if every command succeeded
+ * returns 1 if any command failed
+ * returns <0 if the input could not be read
+ */
+static int batch_main(struct platform_intf *intf, const char *path)
+{
+	FILE *in;
+	char *line = NULL, *cmdline = NULL;
+	size_t line_sz = 0;
+	ssize_t len;
+	int cmd_num = 0, failed = 0;
+
+	if (!strcmp(path, "-")) {
+		in = stdin;
+	} else {
+		in = fopen(path, "r");
+		if (!in) {
+			lperror(LOG_ERR, "Unable to open batch file %s", path);
+			return -1;
+		}
+	}
+
+	while ((len = getline(&line, &line_sz, in)) >= 0) {
+		char *args[BATCH_MAX_ARGS];
+		char *word, *saveptr;
+		bool too_many = false;
+		int nargs = 0, status;
+
+		if (len > 0 && line[len - 1] == '\n')
+			line[--len] = '\0';
+
+		free(cmdline);
+		cmdline = mosys_strdup(line);
+
+		for (word = strtok_r(line, " \t", &saveptr); word;
+		     word = strtok_r(NULL, " \t", &saveptr)) {
+			if (nargs == 0 && word[0] == '#')
+				break;
+			if (nargs == ARRAY_SIZE(args)) {
+				too_many = true;
+				break;
+			}
+			args[nargs++] = word;
+		}
+
+		if (nargs == 0)
+			continue;
+
+		cmd_num++;
+		mosys_printf("--- begin %d %s\n", cmd_num, cmdline);
+		mosys_output_flush();
+
+		if (too_many) {
+			lprintf(LOG_ERR, "Too many arguments\n");
+			status = EINVAL;
+		} else {
+			status = mosys_run_cmd(intf, nargs, args);
+		}
+
+		fflush(stderr);
+		mosys_printf("--- end %d status=%d\n", cmd_num, status & 0xff);
+		mosys_output_flush();
+
+		if (status)
+			failed = 1;
+	}
+
+	/* getline() fails at the end of input too, tell the two apart */
+	if (ferror(in)) {
+		lperror(LOG_ERR, "Unable to read batch file %s", path);
+		failed = -1;
+	}
+
+	free(cmdline);
+	free(line);
+	if (in != stdin)
+		fclose(in);
+
+	return failed;
+}
+
+int mosys_main(int argc, char **argv)
+{
+	int rc;
 	int argflag;
+	int trace_id;
 	int verbose = LOG_ERR;
 	bool print_platforms_opt = false;
 	bool showtree = false;
+	bool use_platform_cache = true;
 	char *p_opt = NULL;
+	char *batch_file = NULL;
+	char *daemon_socket = NULL;
+	bool trace_summary = false;
+	char *trace_file = NULL;
 	struct platform_intf *intf;
 	enum kv_pair_style style = KV_STYLE_VALUE;
 
 	mosys_globals_init();
 
-	while ((argflag = getopt(argc, argv, "klvtSs:p:h")) > 0) {
+	while ((argflag = getopt(argc, argv, "+kljCvtSs:p:Pb:D:TJ:ch")) > 0) {
 		switch (argflag) {
 		case 'k':
 			style = KV_STYLE_PAIR;
@@ -178,6 +376,12 @@ int mosys_main(int argc, char **argv)
 		case 'l':
 			style = KV_STYLE_LONG;
 			break;
+		case 'j':
+			style = KV_STYLE_JSON;
+			break;
+		case 'C':
+			style = KV_STYLE_CBOR;
+			break;
 		case 's':
 			style = KV_STYLE_SINGLE;
 			if (!optarg) {
@@ -198,6 +402,26 @@ int mosys_main(int argc, char **argv)
 		case 'p':
 			p_opt = optarg;
 			break;
+		case 'P':
+			use_platform_cache = false;
+			break;
+		case 'b':
+			batch_file = optarg;
+			break;
+		case 'D':
+			daemon_socket = optarg;
+			break;
+		case 'T':
+			trace_summary = true;
+			trace_enable();
+			break;
+		case 'J':
+			trace_file = optarg;
+			trace_enable();
+			break;
+		case 'c':
+			print_counters = true;
+			break;
 		case 'h':
 			usage();
 			exit(EXIT_SUCCESS);
@@ -225,9 +449,15 @@ int mosys_main(int argc, char **argv)
 	mosys_set_verbosity(verbose);
 
 	/* try to identify the platform */
+	mosys_set_use_platform_cache(use_platform_cache);
+	counters_reset();
+	trace_id = trace_begin("platform", "setup");
 	intf = mosys_platform_setup(p_opt);
+	trace_end(trace_id);
+	counters_report("platform setup", print_counters);
 	if (!intf) {
 		lprintf(LOG_ERR, "Platform not supported\n");
+		log_recorder_dump();
 		rc = -1;
 		goto exit;
 	}
@@ -239,20 +469,30 @@ int mosys_main(int argc, char **argv)
 		goto exit_platform_cleanup;
 	}
 
+	if (daemon_socket) {
+		rc = mosys_daemon_serve(intf, daemon_socket);
+		goto exit_platform_cleanup;
+	}
+
+	if (batch_file) {
+		rc = batch_main(intf, batch_file);
+		goto exit_platform_cleanup;
+	}
+
 	/* run command */
-	errno = 0;
-	rc = intf_main(intf, argc - optind, argv + optind);
-	errsv = errno;
-	if (rc < 0 && errsv == ENOSYS)
-		lprintf(LOG_ERR, "Command not supported on this platform\n");
+	rc = mosys_run_cmd(intf, argc - optind, argv + optind);
 
 exit_platform_cleanup:
 	mosys_platform_destroy(intf);
 
 exit:
+	if (trace_file)
+		trace_write_json(trace_file);
+	if (trace_summary)
+		trace_print_summary(stderr);
+	trace_reset();
+
 	mosys_log_halt();
 
-	if (rc < 0 && errsv > 0)
-		return errsv;
 	return rc;
 }
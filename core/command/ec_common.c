@@ -8,6 +8,7 @@
 
 #include "lib/math.h"
 #include "mosys/command_list.h"
+#include "mosys/globals.h"
 #include "mosys/kv_pair.h"
 #include "mosys/log.h"
 #include "mosys/platform.h"
@@ -30,18 +31,22 @@ static int ec_info_common(struct ec_cb *ec)
 
 	kv = kv_pair_new();
 
-	if (ec->vendor && ec->vendor(ec, vendor, ARRAY_SIZE(vendor)) >= 0)
+	/* each of these is an EC command, skip those filtered out by -s */
+	if (ec->vendor && kv_key_wanted("vendor") &&
+	    ec->vendor(ec, vendor, ARRAY_SIZE(vendor)) >= 0)
 		kv_pair_add(kv, "vendor", vendor);
-	if (ec->name && ec->name(ec, name, ARRAY_SIZE(name)) >= 0)
+	if (ec->name && kv_key_wanted("name") &&
+	    ec->name(ec, name, ARRAY_SIZE(name)) >= 0)
 		kv_pair_add(kv, "name", name);
-	if (ec->fw_version &&
+	if (ec->fw_version && kv_key_wanted("fw_version") &&
 	    ec->fw_version(ec, fw_version, ARRAY_SIZE(fw_version)) >= 0)
 		kv_pair_add(kv, "fw_version", fw_version);
 
 	rc = kv_pair_print(kv);
 	kv_pair_free(kv);
 
-	if (ec->destroy && ec->destroy(ec) < 0)
+	if (!mosys_get_keep_devices_open() &&
+	    ec->destroy && ec->destroy(ec) < 0)
 		lprintf(LOG_ERR, "%s: EC destroy failed!\n", __func__);
 
 	return rc;
@@ -95,7 +100,8 @@ static int pd_chip_info(struct platform_intf *intf, struct platform_cmd *cmd,
 
 	rv = ec->pd_chip_info(ec, port);
 
-	if (ec->destroy && ec->destroy(ec) < 0)
+	if (!mosys_get_keep_devices_open() &&
+	    ec->destroy && ec->destroy(ec) < 0)
 		lprintf(LOG_ERR, "%s: EC destroy failed!\n", __func__);
 
 	return rv;
@@ -111,6 +117,7 @@ static struct platform_cmd ec_cmds[] = {
 		.name	= "info",
 		.desc	= "Print basic EC information",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = ec_info }
 	},
 	{ NULL }
@@ -121,12 +128,14 @@ static struct platform_cmd pd_cmds[] = {
 		.name	= "info",
 		.desc	= "Print basic PD information",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = pd_info }
 	},
 	{
 		.name	= "chip",
 		.desc	= "Print PD chip information",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = pd_chip_info }
 	},
 	{ NULL }
@@ -137,6 +146,7 @@ static struct platform_cmd fp_cmds[] = {
 		.name	= "info",
 		.desc	= "Print basic FP MCU information",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = fp_info }
 	},
 	{ NULL }
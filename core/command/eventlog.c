@@ -33,36 +33,375 @@
 #include <string.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <limits.h>
+#include <unistd.h>
 
+#include "lib/elog.h"
 #include "lib/elog_smbios.h"
 
 #include "mosys/alloc.h"
 #include "mosys/command_list.h"
+#include "mosys/context.h"
 #include "mosys/log.h"
 #include "mosys/kv_pair.h"
+#include "mosys/output.h"
 #include "mosys/platform.h"
 
-static int eventlog_smbios_list_callback(struct platform_intf *intf,
-                                         struct smbios_log_entry *entry,
-                                         void *arg, int *complete)
+/* options of "eventlog list" */
+struct eventlog_list_opts {
+	int last;		/* print the last records only, <0 for all */
+	int entry;		/* print this record only, <0 for all */
+	int from, to;		/* print these records only, <0 for all */
+	int reverse;		/* newest first */
+	int filter_types;	/* print the types set in types only */
+	uint8_t types[256];
+	uint64_t since, until;	/* time keys of the entries to print */
+	const char *cursor;	/* print entries after this cursor only */
+};
+
+/*
+ * The cursor of "eventlog list --since-cursor" is a small text file
+ * locating the last entry listed, so that the next listing can start
+ * after it:
+ *
+ *   mosys-eventlog-cursor 1
+ *   offset=1234
+ *   entry=57
+ *   hash=5b7e31f2
+ */
+struct eventlog_cursor {
+	uint32_t offset;	/* of the entry in the log area */
+	int entry;		/* number of the record following it */
+	uint32_t hash;		/* see smbios_eventlog_entry_hash() */
+};
+
+/*
+ * eventlog_cursor_read  -  read an eventlog cursor
+ *
+ * @path:	cursor file
+ * @cursor:	cursor to fill in
+ *
+ * returns 1 if the cursor was read
+ * returns 0 if there is no cursor file yet, or it is not a cursor
+ * returns <0 to indicate failure
+ */
+static int eventlog_cursor_read(const char *path,
+				struct eventlog_cursor *cursor)
 {
-	int *entry_count = arg;
+	FILE *fp;
 	int rc;
-	struct kv_pair *kv;
 
-	if (entry->length == 0) {
-		lprintf(LOG_ERR, "Zero-length eventlog entry detected.\n");
-		*complete = 1;
+	fp = fopen(path, "r");
+	if (!fp) {
+		if (errno == ENOENT)
+			return 0;
+		lperror(LOG_ERR, "Unable to open %s", path);
 		return -1;
 	}
 
-	/* verify entry checksum on OEM types */
-	if (entry->type >= SMBIOS_EVENT_TYPE_OEM &&
-	    intf->cb->eventlog->verify &&
-	    !intf->cb->eventlog->verify(intf, entry)) {
+	rc = fscanf(fp, "mosys-eventlog-cursor 1\noffset=%" SCNu32
+		    "\nentry=%d\nhash=%" SCNx32 "\n",
+		    &cursor->offset, &cursor->entry, &cursor->hash);
+	fclose(fp);
+
+	/* start over, the next listing writes a good cursor again */
+	if (rc != 3) {
+		lprintf(LOG_WARNING, "%s is not an eventlog cursor, listing "
+			"all entries\n", path);
 		return 0;
 	}
 
+	return 1;
+}
+
+/*
+ * eventlog_cursor_write  -  write an eventlog cursor
+ *
+ * @path:	cursor file
+ * @cursor:	cursor to write
+ *
+ * returns 0 to indicate success
+ * returns <0 to indicate failure
+ */
+static int eventlog_cursor_write(const char *path,
+				 const struct eventlog_cursor *cursor)
+{
+	char tmp_path[PATH_MAX];
+	FILE *fp;
+	int fd, rc;
+
+	if (snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX",
+		     path) >= (int)sizeof(tmp_path)) {
+		errno = ENAMETOOLONG;
+		lperror(LOG_ERR, "Unable to write %s", path);
+		return -1;
+	}
+
+	/*
+	 * Write a new file and rename it, so readers never see a partial one.
+	 * mkstemp() never opens an existing file, so a link planted in the
+	 * cursor's directory cannot make us write elsewhere.
+	 */
+	fd = mkstemp(tmp_path);
+	if (fd < 0) {
+		lperror(LOG_ERR, "Unable to create %s", tmp_path);
+		return -1;
+	}
+	fp = fdopen(fd, "w");
+	if (!fp) {
+		lperror(LOG_ERR, "Unable to create %s", tmp_path);
+		close(fd);
+		unlink(tmp_path);
+		return -1;
+	}
+
+	fprintf(fp, "mosys-eventlog-cursor 1\noffset=%" PRIu32
+		"\nentry=%d\nhash=%08" PRIx32 "\n",
+		cursor->offset, cursor->entry, cursor->hash);
+	rc = fflush(fp) || ferror(fp) || fsync(fd);
+	if (fclose(fp) || rc || rename(tmp_path, path) < 0) {
+		lperror(LOG_ERR, "Unable to write %s", path);
+		unlink(tmp_path);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * eventlog_cursor_find  -  find the entries added after a cursor
+ *
+ * @elog:	indexed eventlog
+ * @first:	number of the first record of each entry, then the total
+ * @cursor:	cursor read from the last listing
+ *
+ * The log changed under the cursor if its entry is not where it was, or
+ * if an entry added since says the log was cleared or shrunk.
+ *
+ * returns the first entry after the cursor
+ * returns <0 if the log changed and has to be listed again
+ */
+static int eventlog_cursor_find(const struct smbios_eventlog_snapshot *elog,
+				const int *first,
+				const struct eventlog_cursor *cursor)
+{
+	int lo = 0, hi = elog->entries, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (elog->offsets[mid] < cursor->offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo == elog->entries || elog->offsets[lo] != cursor->offset ||
+	    first[lo + 1] != cursor->entry ||
+	    smbios_eventlog_entry_hash(smbios_eventlog_snapshot_entry(
+		    elog, lo)) != cursor->hash)
+		return -1;
+
+	for (hi = lo + 1; hi < elog->entries; hi++) {
+		if (smbios_eventlog_snapshot_entry(elog, hi)->type ==
+		    SMBIOS_EVENT_TYPE_LOGCLEAR)
+			return -1;
+	}
+
+	return lo + 1;
+}
+
+/*
+ * eventlog_add_type  -  add the type of an entry to a record
+ *
+ * @intf:	platform interface
+ * @entry:	eventlog entry
+ * @kv:		record
+ */
+static void eventlog_add_type(struct platform_intf *intf,
+			      struct smbios_log_entry *entry,
+			      struct kv_pair *kv)
+{
+	/* look for a custom print_type handler */
+	if (intf->cb->eventlog->print_type == NULL ||
+	    intf->cb->eventlog->print_type(intf, entry, kv) == 0) {
+		/*
+		 * not handled by custom print_type handler
+		 * FIXME: pass "Unknown event" to val2str.
+		 */
+		const char *type = smbios_get_event_type_string(entry);
+		kv_pair_add(kv, "type", type ? type : "Unknown");
+	}
+}
+
+/*
+ * eventlog_type_lookup  -  select the entry types matching a --type value
+ *
+ * @intf:	platform interface
+ * @name:	type number, or name as printed by "eventlog list"
+ * @types:	flags indexed by entry type, set for matching types
+ *
+ * returns 0 to indicate success
+ * returns <0 to indicate failure
+ */
+static int eventlog_type_lookup(struct platform_intf *intf, const char *name,
+				uint8_t *types)
+{
+	union {
+		struct smbios_log_entry entry;
+		uint8_t buf[256];
+	} e;
+	struct kv_pair *kv;
+	const char *type;
+	char *end;
+	long n;
+	int found = 0;
+
+	n = strtol(name, &end, 0);
+	if (*name && !*end) {
+		if (n < 0 || n > 0xff)
+			return -1;
+		types[n] = 1;
+		return 0;
+	}
+
+	/* names are resolved once here, not for each entry */
+	memset(&e, 0, sizeof(e));
+	for (n = 0; n <= 0xff; n++) {
+		e.entry.type = n;
+		kv = kv_pair_new();
+		eventlog_add_type(intf, &e.entry, kv);
+		type = kv_pair_get(kv, "type");
+		if (type && !strcasecmp(type, name)) {
+			types[n] = 1;
+			found = 1;
+		}
+		kv_pair_free(kv);
+	}
+
+	if (!found)
+		lprintf(LOG_ERR, "Unknown eventlog type \"%s\"\n", name);
+
+	return found ? 0 : -1;
+}
+
+static int eventlog_list_parse(struct platform_intf *intf,
+			       struct platform_cmd *cmd, int argc, char **argv,
+			       struct eventlog_list_opts *opts)
+{
+	const char *opt, *val;
+	char *end;
+	long n;
+	int i;
+
+	memset(opts, 0, sizeof(*opts));
+	opts->last = opts->entry = opts->from = opts->to = -1;
+	opts->until = UINT64_MAX;
+
+	for (i = 0; i < argc; i++) {
+		opt = argv[i];
+		if (!strcmp(opt, "--reverse")) {
+			opts->reverse = 1;
+			continue;
+		}
+
+		if (i + 1 == argc)
+			break;
+		val = argv[++i];
+
+		if (!strcmp(opt, "--type")) {
+			if (eventlog_type_lookup(intf, val, opts->types) < 0)
+				break;
+			opts->filter_types = 1;
+			continue;
+		}
+		if (!strcmp(opt, "--since-cursor")) {
+			opts->cursor = val;
+			continue;
+		}
+		if (!strcmp(opt, "--since")) {
+			if (smbios_eventlog_time_key_parse(val,
+							   &opts->since) < 0)
+				break;
+			continue;
+		}
+		if (!strcmp(opt, "--until")) {
+			if (smbios_eventlog_time_key_parse(val,
+							   &opts->until) < 0)
+				break;
+			continue;
+		}
+
+		n = strtol(val, &end, 10);
+		if (!*val || *end || n < 0 || n > INT_MAX)
+			break;
+
+		if (!strcmp(opt, "--last"))
+			opts->last = n;
+		else if (!strcmp(opt, "--entry"))
+			opts->entry = n;
+		else if (!strcmp(opt, "--from"))
+			opts->from = n;
+		else if (!strcmp(opt, "--to"))
+			opts->to = n;
+		else
+			break;
+	}
+
+	if (i < argc) {
+		platform_cmd_usage(cmd);
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* a relative path would be taken from the daemon's directory */
+	if (opts->cursor && opts->cursor[0] != '/') {
+		lprintf(LOG_ERR, "Cursor file %s is not an absolute path\n",
+			opts->cursor);
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* the cursor would skip entries which were never printed */
+	if (opts->cursor && (opts->last >= 0 || opts->entry >= 0)) {
+		lprintf(LOG_ERR, "--since-cursor cannot be used with --last "
+			"or --entry\n");
+		errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* entries with a bad checksum are left out */
+static int eventlog_entry_valid(struct platform_intf *intf,
+				struct smbios_log_entry *entry)
+{
+	return entry->type < SMBIOS_EVENT_TYPE_OEM ||
+	       !intf->cb->eventlog->verify ||
+	       intf->cb->eventlog->verify(intf, entry);
+}
+
+/*
+ * eventlog_print_entry  -  print the records of an eventlog entry
+ *
+ * @intf:	platform interface
+ * @entry:	eventlog entry
+ * @entry_count: number of the first record, increased by the number of
+ *		records printed
+ *
+ * returns 0 to indicate success
+ * returns <0 to indicate failure
+ */
+static int eventlog_print_entry(struct platform_intf *intf,
+				struct smbios_log_entry *entry,
+				int *entry_count)
+{
+	int rc;
+	struct kv_pair *kv;
+
+	if (!eventlog_entry_valid(intf, entry))
+		return 0;
+
 	/* see if there is a multi event handler */
 	if (intf->cb->eventlog->print_multi) {
 		int count = intf->cb->eventlog->print_multi(intf, entry,
@@ -78,23 +417,17 @@ static int eventlog_smbios_list_callback(struct platform_intf *intf,
 	kv = kv_pair_new();
 
 	/* print the record number */
-	kv_pair_fmt(kv, "entry", "%d", *entry_count);
+	kv_pair_add_int(kv, "entry", *entry_count);
 
 	*entry_count += 1;
 
 	/* print the timestamp */
-	smbios_eventlog_print_timestamp(intf, entry, kv);
+	if (kv_key_wanted("timestamp"))
+		smbios_eventlog_print_timestamp(intf, entry, kv);
 
-	/* look for a custom print_type handler */
-	if (intf->cb->eventlog->print_type == NULL ||
-	    intf->cb->eventlog->print_type(intf, entry, kv) == 0) {
-		/*
-		 * not handled by custom print_type handler
-		 * FIXME: pass "Unknown event" to val2str.
-		 */
-		const char *type = smbios_get_event_type_string(entry);
-		kv_pair_add(kv, "type", type ? type : "Unknown");
-	}
+	/* filtered out by -s otherwise */
+	if (kv_key_wanted("type"))
+		eventlog_add_type(intf, entry, kv);
 
 	/* look for a custom print_data handler */
 	if (intf->cb->eventlog->print_data)
@@ -106,15 +439,200 @@ static int eventlog_smbios_list_callback(struct platform_intf *intf,
 	return rc;
 }
 
+/*
+ * count the records eventlog_print_entry() would print for an entry, from
+ * its type and data bytes, without decoding it
+ */
+static int eventlog_entry_records(struct platform_intf *intf,
+				  struct smbios_log_entry *entry)
+{
+	int count = 0;
+
+	if (!eventlog_entry_valid(intf, entry))
+		return 0;
+
+	if (intf->cb->eventlog->count_multi)
+		count = intf->cb->eventlog->count_multi(intf, entry);
+
+	return count > 0 ? count : 1;
+}
+
+/*
+ * eventlog_entry_search  -  binary search record numbers of entries
+ *
+ * @first:	non-decreasing record numbers, one per entry
+ * @entries:	number of entries
+ * @record:	record number
+ *
+ * returns the first entry whose number in @first is above @record,
+ * @entries if there is none
+ */
+static int eventlog_entry_search(const int *first, int entries, int record)
+{
+	int lo = 0, hi = entries, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (first[mid] <= record)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/* check the filters which only need the entry header */
+static int eventlog_entry_wanted(const struct eventlog_list_opts *opts,
+				 const struct smbios_log_entry *entry)
+{
+	uint64_t key;
+
+	if (opts->filter_types && !opts->types[entry->type])
+		return 0;
+
+	if (opts->since || opts->until != UINT64_MAX) {
+		key = smbios_eventlog_time_key(entry);
+		if (key < opts->since || key > opts->until)
+			return 0;
+	}
+
+	return 1;
+}
+
 static int eventlog_smbios_list_cmd(struct platform_intf *intf,
                                     struct platform_cmd *cmd,
                                     int argc, char **argv)
 {
+	struct smbios_eventlog_snapshot elog;
+	struct eventlog_list_opts opts;
+	struct eventlog_cursor cursor;
+	int have_cursor = 0;
 	int entry_count = 0;
+	int *first, *selected;
+	int corrupt, i, lo, hi, n, num, records;
+	int rc = 0;
+
+	if (eventlog_list_parse(intf, cmd, argc, argv, &opts) < 0)
+		return -1;
 
-	return smbios_eventlog_foreach_event(
-		intf, intf->cb->eventlog->verify_header,
-		eventlog_smbios_list_callback, &entry_count);
+	if (opts.cursor) {
+		have_cursor = eventlog_cursor_read(opts.cursor, &cursor);
+		if (have_cursor < 0)
+			return -1;
+	}
+
+	if (smbios_eventlog_snapshot_fetch(intf, &elog) < 0)
+		return -1;
+
+	if (intf->cb->eventlog->verify_header &&
+	    intf->cb->eventlog->verify_header(
+		    smbios_eventlog_get_header(elog.iter)) < 0)
+		return -1;
+
+	corrupt = smbios_eventlog_snapshot_index(&elog) < 0;
+
+	if (opts.last < 0 && opts.entry < 0 && opts.from < 0 && opts.to < 0 &&
+	    !opts.reverse && !opts.filter_types && !opts.since &&
+	    opts.until == UINT64_MAX && !opts.cursor) {
+		for (i = 0; i < elog.entries && !kv_pair_print_stopped(); i++)
+			rc |= eventlog_print_entry(
+				intf, smbios_eventlog_snapshot_entry(&elog, i),
+				&entry_count);
+		goto out;
+	}
+
+	/* number the records, to pick the entries and print them anywhere */
+	first = mosys_arena_alloc(mosys_cmd_arena(),
+				  (elog.entries + 1) * sizeof(*first));
+	for (i = 0; i < elog.entries; i++) {
+		first[i] = entry_count;
+		entry_count += eventlog_entry_records(
+			intf, smbios_eventlog_snapshot_entry(&elog, i));
+	}
+	first[i] = entry_count;
+
+	/* entries holding the records asked for */
+	lo = 0;
+	hi = elog.entries;
+	if (opts.from >= 0)
+		lo = eventlog_entry_search(first + 1, elog.entries, opts.from);
+	if (opts.to >= 0)
+		hi = eventlog_entry_search(first, elog.entries, opts.to);
+	if (opts.entry >= 0) {
+		i = eventlog_entry_search(first + 1, elog.entries, opts.entry);
+		if (i == elog.entries || first[i] > opts.entry) {
+			lprintf(LOG_ERR, "No eventlog entry %d\n", opts.entry);
+			errno = ENOENT;
+			return -1;
+		}
+		lo = i > lo ? i : lo;
+		hi = i + 1 < hi ? i + 1 : hi;
+	}
+	if (have_cursor) {
+		i = eventlog_cursor_find(&elog, first, &cursor);
+		if (i < 0)
+			lprintf(LOG_WARNING, "Eventlog changed since %s was "
+				"written, listing all entries\n", opts.cursor);
+		lo = i > lo ? i : lo;
+	}
+
+	/* then those passing the filters, from their headers only */
+	selected = mosys_arena_alloc(mosys_cmd_arena(),
+				     (elog.entries + 1) * sizeof(*selected));
+	num = 0;
+	for (i = lo; i < hi; i++) {
+		if (first[i] < first[i + 1] &&
+		    eventlog_entry_wanted(
+			    &opts, smbios_eventlog_snapshot_entry(&elog, i)))
+			selected[num++] = i;
+	}
+
+	lo = 0;
+	if (opts.last >= 0) {
+		for (lo = num, records = 0; lo > 0 && records < opts.last; ) {
+			lo--;
+			n = selected[lo];
+			records += first[n + 1] - first[n];
+		}
+	}
+
+	for (i = lo; i < num && !kv_pair_print_stopped(); i++) {
+		n = selected[opts.reverse ? lo + num - 1 - i : i];
+
+		entry_count = first[n];
+		rc |= eventlog_print_entry(
+			intf, smbios_eventlog_snapshot_entry(&elog, n),
+			&entry_count);
+	}
+
+	/*
+	 * Move the cursor to the newest entry printed, once all of them were
+	 * printed and written out: entries left out by --to or --until must
+	 * still be listed next time.
+	 */
+	if (opts.cursor && i == num && num > lo && !rc) {
+		if (mosys_output_flush() < 0) {
+			lperror(LOG_ERR, "Failed to write eventlog entries");
+			rc = -1;
+			goto out;
+		}
+
+		i = selected[num - 1];
+		cursor.offset = elog.offsets[i];
+		cursor.entry = first[i + 1];
+		cursor.hash = smbios_eventlog_entry_hash(
+			smbios_eventlog_snapshot_entry(&elog, i));
+		rc = eventlog_cursor_write(opts.cursor, &cursor);
+	}
+
+out:
+	if (corrupt) {
+		lprintf(LOG_ERR, "Zero-length eventlog entry detected.\n");
+		rc = -1;
+	}
+
+	return rc;
 }
 
 static int eventlog_smbios_add_cmd(struct platform_intf *intf,
@@ -184,11 +702,39 @@ static int eventlog_smbios_clear_cmd(struct platform_intf *intf,
 	return intf->cb->eventlog->clear(intf);
 }
 
+/*
+ * fields of "eventlog list", only ever add to the end; the timestamp is in
+ * seconds since the epoch, or a string if it could not be parsed
+ */
+#define EVENTLOG_DATA_FIELD(key, type)	{ key, type },
+static const struct kv_schema eventlog_list_schema[] = {
+	{ "entry",		KV_TYPE_INT },
+	{ "timestamp",		KV_TYPE_INT },
+	{ "type",		KV_TYPE_STRING },
+	{ "value",		KV_TYPE_STRING },
+	ELOG_DATA_FIELDS(EVENTLOG_DATA_FIELD)
+	{ NULL }
+};
+#undef EVENTLOG_DATA_FIELD
+
 static struct platform_cmd eventlog_smbios_cmds[] = {
 	{
 		.name	= "list",
 		.desc	= "List Event Log",
+		.usage	= "[--since-cursor <file>] "
+			  "[--type <type>]... [--since <time>] "
+			  "[--until <time>] [--from <n>] [--to <n>] "
+			  "[--entry <n>] [--last <n>] [--reverse]\n\n"
+			  "type is a number or a name as listed, time is "
+			  "\"YYYY-MM-DD[ HH:MM[:SS]]\", --from, --to and "
+			  "--entry select entries by number, --last keeps "
+			  "the last n entries selected, --reverse prints "
+			  "the newest first, --since-cursor prints the "
+			  "entries added since the last listing with the "
+			  "same cursor file, given as an absolute path",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_LIST,
+		.schema	= eventlog_list_schema,
 		.arg	= { .func = eventlog_smbios_list_cmd }
 	},
 	{
@@ -0,0 +1,152 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// cmocka doesn't include some headers it uses, e.g. setjmp. Prevent
+// clang-format from putting the headers in order, so it gets the above
+// includes.
+// clang-format off
+#include <cmocka.h>
+// clang-format on
+
+#include "mosys/kv_pair.h"
+#include "mosys/platform.h"
+
+#include "lib/smbios_tables.h"
+
+extern struct platform_cmd cmd_eventlog;
+
+/* two boot entries, then the end of the log */
+static uint8_t fake_log[] = {
+	SMBIOS_EVENT_TYPE_BOOT, 12, 0x20, 0x06, 0x01, 0x12, 0x00, 0x00,
+	0x01, 0x00, 0x00, 0x00,
+	SMBIOS_EVENT_TYPE_BOOT, 12, 0x20, 0x06, 0x02, 0x12, 0x00, 0x00,
+	0x02, 0x00, 0x00, 0x00,
+	SMBIOS_EVENT_TYPE_ENDLOG, 0xff, 0xff, 0xff,
+};
+
+static int fake_fetch(struct platform_intf *intf, uint8_t **data,
+		      size_t *length, off_t *header_offset,
+		      off_t *data_offset)
+{
+	*data = fake_log;
+	*length = sizeof(fake_log);
+	*header_offset = 0;
+	*data_offset = 0;
+	return 0;
+}
+
+static struct eventlog_cb fake_eventlog_cb = {
+	.fetch	= fake_fetch,
+};
+
+static struct platform_cb fake_cb = {
+	.eventlog	= &fake_eventlog_cb,
+};
+
+static struct platform_intf fake_intf = {
+	.cb	= &fake_cb,
+};
+
+static int count_record(struct kv_pair *kv_list, void *arg)
+{
+	(*(int *)arg)++;
+	return 0;
+}
+
+/* run "eventlog list --since-cursor @path", return its result */
+static int list_since_cursor(const char *path, int *records)
+{
+	struct platform_cmd *cmd;
+	char *argv[] = { "--since-cursor", (char *)path };
+	int rc;
+
+	cmd = platform_find_sub_cmd(&cmd_eventlog, "list");
+	assert_non_null(cmd);
+
+	*records = 0;
+	kv_pair_set_sink(count_record, records);
+	errno = 0;
+	rc = cmd->arg.func(&fake_intf, cmd, 2, argv);
+	kv_pair_set_sink(NULL, NULL);
+
+	return rc;
+}
+
+static void write_file(const char *path, const char *text)
+{
+	FILE *fp = fopen(path, "w");
+
+	assert_non_null(fp);
+	fputs(text, fp);
+	assert_int_equal(fclose(fp), 0);
+}
+
+static void cursor_lists_new_entries(void **state)
+{
+	char dir[] = "/tmp/eventlog_unittest.XXXXXX";
+	char path[64];
+	int records;
+
+	assert_non_null(mkdtemp(dir));
+	snprintf(path, sizeof(path), "%s/cursor", dir);
+
+	assert_int_equal(list_since_cursor(path, &records), 0);
+	assert_int_equal(records, 2);
+	assert_int_equal(list_since_cursor(path, &records), 0);
+	assert_int_equal(records, 0);
+
+	unlink(path);
+	rmdir(dir);
+}
+
+/* a damaged cursor lists everything again, and is replaced */
+static void corrupt_cursor_is_replaced(void **state)
+{
+	char dir[] = "/tmp/eventlog_unittest.XXXXXX";
+	char path[64];
+	int records;
+
+	assert_non_null(mkdtemp(dir));
+	snprintf(path, sizeof(path), "%s/cursor", dir);
+
+	write_file(path, "mosys-eventlog-cursor 1\noffs");
+	assert_int_equal(list_since_cursor(path, &records), 0);
+	assert_int_equal(records, 2);
+	assert_int_equal(list_since_cursor(path, &records), 0);
+	assert_int_equal(records, 0);
+
+	unlink(path);
+	rmdir(dir);
+}
+
+static void relative_cursor_is_rejected(void **state)
+{
+	int records;
+
+	assert_int_equal(list_since_cursor("cursor", &records), -1);
+	assert_int_equal(errno, EINVAL);
+	assert_int_equal(records, 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(cursor_lists_new_entries),
+		cmocka_unit_test(corrupt_cursor_is_replaced),
+		cmocka_unit_test(relative_cursor_is_rejected),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -43,6 +43,40 @@
 #include "lib/nonspd.h"
 #include "lib/spd.h"
 
+/*
+ * fields printed by each subcommand: when -s asks for none of them, no
+ * SPD is read, and the command fails as it would if it printed records
+ * without the keys asked for
+ */
+static const enum spd_field_type geometry_fields[] = {
+	SPD_GET_SIZE, SPD_GET_RANKS, SPD_GET_WIDTH
+};
+static const enum spd_field_type id_fields[] = {
+	SPD_GET_MFG_ID, SPD_GET_PART_NUMBER
+};
+static const enum spd_field_type timings_fields[] = {
+	SPD_GET_SPEEDS
+};
+static const enum spd_field_type type_fields[] = {
+	SPD_GET_DRAM_TYPE, SPD_GET_MODULE_TYPE
+};
+
+static int spd_fields_wanted(const enum spd_field_type *fields, int count)
+{
+	int i;
+
+	/* every record starts with the DIMM number */
+	if (kv_key_wanted("dimm"))
+		return 1;
+
+	for (i = 0; i < count; i++) {
+		if (spd_field_wanted(fields[i]))
+			return 1;
+	}
+
+	return 0;
+}
+
 static int memory_spd_print_geometry(struct platform_intf *intf, int dimm)
 {
 	struct kv_pair *kv;
@@ -55,8 +89,6 @@ static int memory_spd_print_geometry(struct platform_intf *intf, int dimm)
 		return -1;
 	}
 
-	kv = kv_pair_new();
-
 	spd = new_spd_device(intf, dimm);
 	if (spd == NULL) {
 		lprintf(LOG_DEBUG,
@@ -64,9 +96,11 @@ static int memory_spd_print_geometry(struct platform_intf *intf, int dimm)
 		return 0;	/* not an error */
 	}
 
+	kv = kv_pair_new();
+
 	spd_data = &spd->eeprom.data[0];
 
-	kv_pair_fmt(kv, "dimm", "%u", dimm);
+	kv_pair_add_int(kv, "dimm", dimm);
 	spd_print_field(intf, kv, spd_data, SPD_GET_SIZE);
 	spd_print_field(intf, kv, spd_data, SPD_GET_RANKS);
 	spd_print_field(intf, kv, spd_data, SPD_GET_WIDTH);
@@ -94,7 +128,7 @@ static int memory_nonspd_print_geometry(struct platform_intf *intf, int dimm)
 
 	kv = kv_pair_new();
 
-	kv_pair_fmt(kv, "dimm", "%u", dimm);
+	kv_pair_add_int(kv, "dimm", dimm);
 	nonspd_print_field(kv, info, SPD_GET_SIZE);
 	nonspd_print_field(kv, info, SPD_GET_RANKS);
 	nonspd_print_field(kv, info, SPD_GET_WIDTH);
@@ -116,6 +150,11 @@ static int memory_spd_print_geometry_cmd(struct platform_intf *intf,
 		return -1;
 	}
 
+	if (!spd_fields_wanted(geometry_fields, ARRAY_SIZE(geometry_fields))) {
+		errno = ENOENT;
+		return -1;
+	}
+
 	last_dimm = intf->cb->memory->dimm_count(intf);
 
 	if (argc) {
@@ -154,8 +193,6 @@ static int memory_spd_print_id(struct platform_intf *intf, int dimm)
 		return -1;
 	}
 
-	kv = kv_pair_new();
-
 	spd = new_spd_device(intf, dimm);
 	if (spd == NULL) {
 		lprintf(LOG_DEBUG,
@@ -163,9 +200,11 @@ static int memory_spd_print_id(struct platform_intf *intf, int dimm)
 		return 0;	/* not an error */
 	}
 
+	kv = kv_pair_new();
+
 	spd_data = &spd->eeprom.data[0];
 
-	kv_pair_fmt(kv, "dimm", "%u", dimm);
+	kv_pair_add_int(kv, "dimm", dimm);
 	spd_print_field(intf, kv, spd_data, SPD_GET_MFG_ID);
 	spd_print_field(intf, kv, spd_data, SPD_GET_PART_NUMBER);
 
@@ -192,7 +231,7 @@ static int memory_nonspd_print_id(struct platform_intf *intf, int dimm)
 
 	kv = kv_pair_new();
 
-	kv_pair_fmt(kv, "dimm", "%u", dimm);
+	kv_pair_add_int(kv, "dimm", dimm);
 	nonspd_print_field(kv, info, SPD_GET_MFG_ID);
 	nonspd_print_field(kv, info, SPD_GET_PART_NUMBER);
 
@@ -213,6 +252,11 @@ static int memory_spd_print_id_cmd(struct platform_intf *intf,
 		return -1;
 	}
 
+	if (!spd_fields_wanted(id_fields, ARRAY_SIZE(id_fields))) {
+		errno = ENOENT;
+		return -1;
+	}
+
 	last_dimm = intf->cb->memory->dimm_count(intf);
 
 	if (argc) {
@@ -251,8 +295,6 @@ static int memory_spd_print_timings(struct platform_intf *intf, int dimm)
 		return -1;
 	}
 
-	kv = kv_pair_new();
-
 	spd = new_spd_device(intf, dimm);
 	if (spd == NULL) {
 		lprintf(LOG_DEBUG,
@@ -260,9 +302,11 @@ static int memory_spd_print_timings(struct platform_intf *intf, int dimm)
 		return 0;	/* not an error */
 	}
 
+	kv = kv_pair_new();
+
 	spd_data = &spd->eeprom.data[0];
 
-	kv_pair_fmt(kv, "dimm", "%u", dimm);
+	kv_pair_add_int(kv, "dimm", dimm);
 	spd_print_field(intf, kv, spd_data, SPD_GET_SPEEDS);
 
 	rc = kv_pair_print(kv);
@@ -288,7 +332,7 @@ static int memory_nonspd_print_timings(struct platform_intf *intf, int dimm)
 
 	kv = kv_pair_new();
 
-	kv_pair_fmt(kv, "dimm", "%u", dimm);
+	kv_pair_add_int(kv, "dimm", dimm);
 	nonspd_print_field(kv, info, SPD_GET_SPEEDS);
 
 	rc = kv_pair_print(kv);
@@ -308,6 +352,11 @@ static int memory_spd_print_timings_cmd(struct platform_intf *intf,
 		return -1;
 	}
 
+	if (!spd_fields_wanted(timings_fields, ARRAY_SIZE(timings_fields))) {
+		errno = ENOENT;
+		return -1;
+	}
+
 	last_dimm = intf->cb->memory->dimm_count(intf);
 
 	if (argc) {
@@ -346,8 +395,6 @@ static int memory_spd_print_type(struct platform_intf *intf, int dimm)
 		return -1;
 	}
 
-	kv = kv_pair_new();
-
 	spd = new_spd_device(intf, dimm);
 	if (spd == NULL) {
 		lprintf(LOG_DEBUG,
@@ -355,9 +402,11 @@ static int memory_spd_print_type(struct platform_intf *intf, int dimm)
 		return 0;	/* not an error */
 	}
 
+	kv = kv_pair_new();
+
 	spd_data = &spd->eeprom.data[0];
 
-	kv_pair_fmt(kv, "dimm", "%u", dimm);
+	kv_pair_add_int(kv, "dimm", dimm);
 	spd_print_field(intf, kv, spd_data, SPD_GET_DRAM_TYPE);
 	spd_print_field(intf, kv, spd_data, SPD_GET_MODULE_TYPE);
 
@@ -383,7 +432,7 @@ static int memory_nonspd_print_type(struct platform_intf *intf, int dimm)
 		return -1;
 
 	kv = kv_pair_new();
-	kv_pair_fmt(kv, "dimm", "%u", dimm);
+	kv_pair_add_int(kv, "dimm", dimm);
 	nonspd_print_field(kv, info, SPD_GET_DRAM_TYPE);
 	nonspd_print_field(kv, info, SPD_GET_MODULE_TYPE);
 
@@ -404,6 +453,11 @@ static int memory_spd_print_type_cmd(struct platform_intf *intf,
 		return -1;
 	}
 
+	if (!spd_fields_wanted(type_fields, ARRAY_SIZE(type_fields))) {
+		errno = ENOENT;
+		return -1;
+	}
+
 	last_dimm = intf->cb->memory->dimm_count(intf);
 
 	if (argc) {
@@ -451,20 +505,54 @@ static int memory_spd_print_all_cmd(struct platform_intf *intf,
 		}
 	}
 
-	rc |= memory_spd_print_type_cmd(intf, cmd, argc, argv);
-	rc |= memory_spd_print_id_cmd(intf, cmd, argc, argv);
-	rc |= memory_spd_print_geometry_cmd(intf, cmd, argc, argv);
-	rc |= memory_spd_print_timings_cmd(intf, cmd, argc, argv);
+	if (!spd_fields_wanted(type_fields, ARRAY_SIZE(type_fields)) &&
+	    !spd_fields_wanted(id_fields, ARRAY_SIZE(id_fields)) &&
+	    !spd_fields_wanted(geometry_fields, ARRAY_SIZE(geometry_fields)) &&
+	    !spd_fields_wanted(timings_fields, ARRAY_SIZE(timings_fields))) {
+		errno = ENOENT;
+		return -1;
+	}
+
+	if (spd_fields_wanted(type_fields, ARRAY_SIZE(type_fields)))
+		rc |= memory_spd_print_type_cmd(intf, cmd, argc, argv);
+	if (spd_fields_wanted(id_fields, ARRAY_SIZE(id_fields)))
+		rc |= memory_spd_print_id_cmd(intf, cmd, argc, argv);
+	if (spd_fields_wanted(geometry_fields, ARRAY_SIZE(geometry_fields)))
+		rc |= memory_spd_print_geometry_cmd(intf, cmd, argc, argv);
+	if (spd_fields_wanted(timings_fields, ARRAY_SIZE(timings_fields)))
+		rc |= memory_spd_print_timings_cmd(intf, cmd, argc, argv);
 
 	return rc;
 }
 
+/* fields of the SPD print commands, only ever add to the end */
+static const struct kv_schema memory_spd_schema[] = {
+	{ "dimm",		KV_TYPE_INT },
+	{ "dram",		KV_TYPE_STRING },
+	{ "module",		KV_TYPE_STRING },
+	{ "module_mfg",		KV_TYPE_STRING },
+	{ "dram_mfg",		KV_TYPE_STRING },
+	{ "mfg_loc",		KV_TYPE_INT },
+	{ "mfg_date",		KV_TYPE_STRING },
+	{ "part_number",	KV_TYPE_STRING },
+	{ "revision_code",	KV_TYPE_STRING },
+	{ "size_mb",		KV_TYPE_INT },
+	{ "ecc",		KV_TYPE_BOOL },
+	{ "ranks",		KV_TYPE_INT },
+	{ "width",		KV_TYPE_INT },
+	{ "checksum",		KV_TYPE_STRING },
+	{ "speeds",		KV_TYPE_STRING },
+	{ NULL }
+};
+
 static struct platform_cmd memory_spd_print_cmds[] = {
 	{
 		.name	= "geometry",
 		.desc	= "Print module geometry and capacity",
 		.usage	= "<dimm number>",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT | CMD_FLAG_LIST,
+		.schema	= memory_spd_schema,
 		.arg	= { .func = memory_spd_print_geometry_cmd }
 	},
 	{
@@ -472,6 +560,8 @@ static struct platform_cmd memory_spd_print_cmds[] = {
 		.desc	= "Print module ID information",
 		.usage	= "<dimm number>",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT | CMD_FLAG_LIST,
+		.schema	= memory_spd_schema,
 		.arg	= { .func = memory_spd_print_id_cmd }
 	},
 	{
@@ -479,6 +569,8 @@ static struct platform_cmd memory_spd_print_cmds[] = {
 		.desc	= "Print module timing capabilities",
 		.usage	= "<dimm number>",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT | CMD_FLAG_LIST,
+		.schema	= memory_spd_schema,
 		.arg	= { .func = memory_spd_print_timings_cmd }
 	},
 	{
@@ -486,6 +578,8 @@ static struct platform_cmd memory_spd_print_cmds[] = {
 		.desc	= "Print module and dram type information",
 		.usage	= "<dimm number>",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT | CMD_FLAG_LIST,
+		.schema	= memory_spd_schema,
 		.arg	= { .func = memory_spd_print_type_cmd }
 	},
 	{
@@ -493,6 +587,8 @@ static struct platform_cmd memory_spd_print_cmds[] = {
 		.desc	= "Print all of the above",
 		.usage	= "<dimm number>",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT | CMD_FLAG_LIST,
+		.schema	= memory_spd_schema,
 		.arg	= { .func = memory_spd_print_all_cmd }
 	},
 	{ NULL }
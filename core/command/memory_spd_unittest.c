@@ -0,0 +1,116 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// cmocka doesn't include some headers it uses, e.g. setjmp. Prevent
+// clang-format from putting the headers in order, so it gets the above
+// includes.
+// clang-format off
+#include <cmocka.h>
+// clang-format on
+
+#include "mosys/kv_pair.h"
+#include "mosys/platform.h"
+
+#include "lib/nonspd.h"
+
+extern struct platform_cmd cmd_memory;
+
+static int fake_dimm_count(struct platform_intf *intf)
+{
+	return 2;
+}
+
+static int fake_nonspd_mem_info(struct platform_intf *intf, int dimm,
+				const struct nonspd_mem_info **info)
+{
+	*info = &hynix_lpddr4x_h9hcnnncpmalhr_nee;
+	return 0;
+}
+
+static struct memory_cb fake_memory_cb = {
+	.dimm_count		= fake_dimm_count,
+	.nonspd_mem_info	= fake_nonspd_mem_info,
+};
+
+static struct platform_cb fake_cb = {
+	.memory	= &fake_memory_cb,
+};
+
+static struct platform_intf fake_intf = {
+	.cb	= &fake_cb,
+};
+
+static int count_record(struct kv_pair *kv_list, void *arg)
+{
+	(*(int *)arg)++;
+	return 0;
+}
+
+/* run "memory spd print <sub>" with -s @keys, return its result */
+static int spd_print(const char *sub, const char *keys, int *records)
+{
+	struct platform_cmd *cmd = &cmd_memory;
+	int rc;
+
+	cmd = platform_find_sub_cmd(cmd, "spd");
+	cmd = platform_find_sub_cmd(cmd, "print");
+	cmd = platform_find_sub_cmd(cmd, sub);
+	assert_non_null(cmd);
+
+	*records = 0;
+	mosys_set_kv_pair_style(KV_STYLE_SINGLE);
+	kv_set_single_key(keys);
+	kv_pair_set_sink(count_record, records);
+	errno = 0;
+	rc = cmd->arg.func(&fake_intf, cmd, 0, NULL);
+
+	kv_pair_set_sink(NULL, NULL);
+	kv_set_single_key(NULL);
+	mosys_set_kv_pair_style(KV_STYLE_VALUE);
+	return rc;
+}
+
+static void wanted_keys_are_printed(void **state)
+{
+	int records;
+
+	assert_int_equal(spd_print("id", "part_number", &records), 0);
+	assert_int_equal(records, 2);
+	assert_int_equal(spd_print("all", "size_mb", &records), 0);
+	assert_int_equal(records, 2);
+	assert_int_equal(spd_print("type", "dimm", &records), 0);
+	assert_int_equal(records, 2);
+}
+
+/* as when the generic -s filter finds none of the keys in a record */
+static void foreign_keys_fail(void **state)
+{
+	int records;
+
+	assert_int_equal(spd_print("id", "timestamp", &records), -1);
+	assert_int_equal(errno, ENOENT);
+	assert_int_equal(records, 0);
+	assert_int_equal(spd_print("all", "timestamp", &records), -1);
+	assert_int_equal(errno, ENOENT);
+	assert_int_equal(records, 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(wanted_keys_are_printed),
+		cmocka_unit_test(foreign_keys_fail),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
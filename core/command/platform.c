@@ -153,30 +153,35 @@ static struct platform_cmd platform_cmds[] = {
 		.name	= "vendor",
 		.desc	= "Display Platform Vendor (deprecated)",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = platform_vendor_cmd }
 	},
 	{
 		.name	= "name",
 		.desc	= "Display Platform Product Name (deprecated)",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = platform_name_cmd }
 	},
 	{
 		.name	= "model",
 		.desc	= "Display Model (deprecated)",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = platform_model_cmd }
 	},
 	{
 		.name	= "chassis",
 		.desc	= "Display Chassis ID (deprecated)",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = platform_chassis_cmd }
 	},
 	{
 		.name	= "sku",
 		.desc	= "Display SKU Number (deprecated)",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = platform_sku_cmd }
 	},
 #ifndef CONFIG_CROS_CONFIG
@@ -184,12 +189,14 @@ static struct platform_cmd platform_cmds[] = {
 		.name	= "brand",
 		.desc	= "Display Brand Code (deprecated)",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = platform_brand_cmd }
 	},
 	{
 		.name	= "customization",
 		.desc	= "Display Customization ID (deprecated)",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = platform_customization_cmd }
 	},
 #endif  /* CONFIG_CROS_CONFIG */
@@ -197,6 +204,7 @@ static struct platform_cmd platform_cmds[] = {
 		.name	= "version",
 		.desc	= "Display Platform Version (deprecated)",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = platform_version_cmd }
 	},
 	{NULL}
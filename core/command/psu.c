@@ -73,6 +73,7 @@ static struct platform_cmd psu_cmds[] = {
 		.name	= "type",
 		.desc	= "Print Power Supply Type",
 		.type	= ARG_TYPE_GETTER,
+		.flags	= CMD_FLAG_BOOT_CONSTANT,
 		.arg	= { .func = psu_print_type},
 	},
 	{ NULL }
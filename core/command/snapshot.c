@@ -0,0 +1,383 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * snapshot.c: everything an inventory needs, in one invocation
+ *
+ * The snapshot is made of sections (platform, memory, ec, ...) which are
+ * mostly produced by running the regular commands with their records
+ * redirected to a sink.  Sections reading the same source are put in the
+ * same lane; lanes run concurrently, each in its own thread and context,
+ * so the snapshot takes about as long as its slowest source.  Records
+ * are printed once every lane is done, in section order, each with a
+ * "section" key telling where it belongs.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mosys/alloc.h"
+#include "mosys/command_list.h"
+#include "mosys/context.h"
+#include "mosys/globals.h"
+#include "mosys/kv_pair.h"
+#include "mosys/log.h"
+#include "mosys/platform.h"
+
+#include "lib/math.h"
+#include "lib/sku.h"
+
+/* sources which can be read at the same time */
+enum snapshot_lane {
+	SNAPSHOT_LANE_EC,	/* also system information and PSU */
+	SNAPSHOT_LANE_PD,
+	SNAPSHOT_LANE_FP,
+	SNAPSHOT_LANE_MEMORY,
+	SNAPSHOT_LANE_EVENTLOG,
+	SNAPSHOT_LANE_MAX,
+};
+
+/* records collected for one section */
+struct snapshot_result {
+	const char *section;
+	struct kv_pair **records;
+	int count;
+	int rc;
+	int errsv;
+};
+
+struct snapshot_section {
+	const char *name;
+	enum snapshot_lane lane;
+	int (*collect)(struct platform_intf *intf,
+		       struct snapshot_result *res);
+};
+
+struct snapshot_lane_state {
+	enum snapshot_lane lane;
+	struct platform_intf *intf;
+	struct mosys_ctx *ctx;
+	struct snapshot_result *results;
+	pthread_t thread;
+	int started;
+};
+
+/*
+ * snapshot_add  -  add a record to a section
+ *
+ * @res:	section results
+ * @kv_list:	record, copied
+ */
+static void snapshot_add(struct snapshot_result *res, struct kv_pair *kv_list)
+{
+	struct kv_pair *record = kv_pair_new();
+
+	kv_pair_add(record, "section", res->section);
+	kv_pair_append(record, kv_list);
+
+	res->records = mosys_realloc(res->records,
+				     (res->count + 1) * sizeof(*res->records));
+	res->records[res->count++] = record;
+}
+
+static int snapshot_collect(struct kv_pair *kv_list, void *arg)
+{
+	snapshot_add(arg, kv_list);
+	return 0;
+}
+
+/*
+ * snapshot_run_args  -  run a getter command with arguments
+ *
+ * @intf:	platform interface
+ * @words:	number of command words at the start of @argv
+ * @argc:	number of command words and arguments
+ * @argv:	command words then arguments, e.g. { "eventlog", "list",
+ *		"--last", "1" }
+ *
+ * returns the result of the command
+ * returns -1 and sets errno to ENOSYS if the platform does not have it
+ */
+static int snapshot_run_args(struct platform_intf *intf, int words, int argc,
+			     const char *argv[])
+{
+	struct platform_cmd *cmd;
+	int i;
+
+	cmd = platform_find_root_cmd(intf, argv[0]);
+	for (i = 1; cmd && i < words; i++)
+		cmd = platform_find_sub_cmd(cmd, argv[i]);
+
+	if (!cmd || cmd->type != ARG_TYPE_GETTER || !cmd->arg.func) {
+		errno = ENOSYS;
+		return -1;
+	}
+
+	return cmd->arg.func(intf, cmd, argc - words, (char **)argv + words);
+}
+
+/* run a getter command, e.g. { "ec", "info" } */
+static int snapshot_run(struct platform_intf *intf, int argc,
+			const char *argv[])
+{
+	return snapshot_run_args(intf, argc, argc, argv);
+}
+
+/* add a string returned by a callback, if there is one, and free it */
+static void snapshot_add_string(struct kv_pair *kv, const char *key,
+				char *value)
+{
+	if (!value)
+		return;
+
+	kv_pair_add(kv, key, value);
+	free(value);
+}
+
+static int snapshot_platform(struct platform_intf *intf,
+			     struct snapshot_result *res)
+{
+	struct kv_pair *kv = kv_pair_new();
+	int sku_number;
+
+	kv_pair_add(kv, "name", intf->name);
+	if (intf->cb && intf->cb->sys && intf->cb->sys->vendor)
+		snapshot_add_string(kv, "vendor", intf->cb->sys->vendor(intf));
+	if (intf->cb && intf->cb->sys && intf->cb->sys->version)
+		snapshot_add_string(kv, "version",
+				    intf->cb->sys->version(intf));
+	snapshot_add_string(kv, "model", sku_get_model(intf));
+	snapshot_add_string(kv, "chassis", sku_get_chassis(intf));
+	snapshot_add_string(kv, "brand", sku_get_brand(intf));
+	snapshot_add_string(kv, "customization",
+			    sku_get_customization(intf));
+
+	sku_number = sku_get_number(intf);
+	if (sku_number >= 0)
+		kv_pair_fmt(kv, "sku", "%d", sku_number);
+
+	snapshot_add(res, kv);
+	kv_pair_free(kv);
+
+	return 0;
+}
+
+static int snapshot_psu(struct platform_intf *intf,
+			struct snapshot_result *res)
+{
+	const char *argv[] = { "psu", "type" };
+
+	return snapshot_run(intf, ARRAY_SIZE(argv), argv);
+}
+
+static int snapshot_ec(struct platform_intf *intf, struct snapshot_result *res)
+{
+	const char *argv[] = { "ec", "info" };
+
+	return snapshot_run(intf, ARRAY_SIZE(argv), argv);
+}
+
+static int snapshot_pd(struct platform_intf *intf, struct snapshot_result *res)
+{
+	const char *argv[] = { "pd", "info" };
+
+	return snapshot_run(intf, ARRAY_SIZE(argv), argv);
+}
+
+static int snapshot_fp(struct platform_intf *intf, struct snapshot_result *res)
+{
+	const char *argv[] = { "fp", "info" };
+
+	return snapshot_run(intf, ARRAY_SIZE(argv), argv);
+}
+
+static int snapshot_memory(struct platform_intf *intf,
+			   struct snapshot_result *res)
+{
+	const char *argv[] = { "memory", "spd", "print", "all" };
+
+	return snapshot_run(intf, ARRAY_SIZE(argv), argv);
+}
+
+struct eventlog_summary {
+	int entries;
+	char *last_timestamp;
+	char *last_type;
+};
+
+/* records are numbered from 0, so the last one gives the count */
+static int summarize_eventlog_entry(struct kv_pair *kv_list, void *arg)
+{
+	struct eventlog_summary *summary = arg;
+	const char *value;
+
+	value = kv_pair_get(kv_list, "entry");
+	if (value)
+		summary->entries = strtol(value, NULL, 10) + 1;
+	value = kv_pair_get(kv_list, "timestamp");
+	if (value) {
+		free(summary->last_timestamp);
+		summary->last_timestamp = mosys_strdup(value);
+	}
+	value = kv_pair_get(kv_list, "type");
+	if (value) {
+		free(summary->last_type);
+		summary->last_type = mosys_strdup(value);
+	}
+
+	return 0;
+}
+
+/*
+ * Only the last entry is decoded: "eventlog list" numbers the records
+ * from the entry headers, and the number of the last one gives the count.
+ */
+static int snapshot_eventlog(struct platform_intf *intf,
+			     struct snapshot_result *res)
+{
+	const char *argv[] = { "eventlog", "list", "--last", "1" };
+	struct eventlog_summary summary = { 0 };
+	struct kv_pair *kv;
+	int rc;
+
+	kv_pair_set_sink(summarize_eventlog_entry, &summary);
+	rc = snapshot_run_args(intf, 2, ARRAY_SIZE(argv), argv);
+	if (rc == 0) {
+		kv = kv_pair_new();
+		kv_pair_fmt(kv, "entries", "%d", summary.entries);
+		if (summary.last_timestamp)
+			kv_pair_add(kv, "last_timestamp",
+				    summary.last_timestamp);
+		if (summary.last_type)
+			kv_pair_add(kv, "last_type", summary.last_type);
+		snapshot_add(res, kv);
+		kv_pair_free(kv);
+	}
+
+	free(summary.last_timestamp);
+	free(summary.last_type);
+	return rc;
+}
+
+static const struct snapshot_section snapshot_sections[] = {
+	{ "platform",	SNAPSHOT_LANE_EC,	snapshot_platform },
+	{ "psu",	SNAPSHOT_LANE_EC,	snapshot_psu },
+	{ "ec",		SNAPSHOT_LANE_EC,	snapshot_ec },
+	{ "pd",		SNAPSHOT_LANE_PD,	snapshot_pd },
+	{ "fp",		SNAPSHOT_LANE_FP,	snapshot_fp },
+	{ "memory",	SNAPSHOT_LANE_MEMORY,	snapshot_memory },
+	{ "eventlog",	SNAPSHOT_LANE_EVENTLOG,	snapshot_eventlog },
+};
+
+static void *snapshot_lane_run(void *arg)
+{
+	struct snapshot_lane_state *state = arg;
+	struct mosys_ctx *prev = mosys_ctx_set(state->ctx);
+	struct snapshot_result *res;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(snapshot_sections); i++) {
+		if (snapshot_sections[i].lane != state->lane)
+			continue;
+
+		res = &state->results[i];
+		kv_pair_set_sink(snapshot_collect, res);
+		errno = 0;
+		res->rc = snapshot_sections[i].collect(state->intf, res);
+		res->errsv = errno;
+	}
+	kv_pair_set_sink(NULL, NULL);
+
+	mosys_ctx_set(prev);
+	return NULL;
+}
+
+/* open the EC devices once, rather than once per lane and command */
+static void snapshot_ec_devices(struct platform_intf *intf,
+				struct ec_cb *ecs[3])
+{
+	ecs[0] = intf->cb ? intf->cb->ec : NULL;
+	ecs[1] = intf->cb && platform_find_root_cmd(intf, "pd") ?
+		 intf->cb->pd : NULL;
+	ecs[2] = intf->cb && platform_find_root_cmd(intf, "fp") ?
+		 intf->cb->fp : NULL;
+}
+
+static int snapshot_cmd(struct platform_intf *intf, struct platform_cmd *cmd,
+			int argc, char **argv)
+{
+	struct snapshot_result results[ARRAY_SIZE(snapshot_sections)] = { };
+	struct snapshot_lane_state lanes[SNAPSHOT_LANE_MAX];
+	uint64_t *counters = mosys_ctx_counters();
+	struct ec_cb *ecs[3];
+	int i, j, rc = 0, errsv = 0;
+
+	snapshot_ec_devices(intf, ecs);
+	for (i = 0; i < ARRAY_SIZE(ecs); i++) {
+		if (ecs[i] && ecs[i]->setup)
+			ecs[i]->setup(ecs[i]);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(results); i++)
+		results[i].section = snapshot_sections[i].name;
+
+	for (i = 0; i < SNAPSHOT_LANE_MAX; i++) {
+		lanes[i] = (struct snapshot_lane_state){
+			.lane = i,
+			.intf = intf,
+			.ctx = mosys_ctx_new(),
+			.results = results,
+		};
+		lanes[i].ctx->keep_devices_open = 1;
+		lanes[i].started = !pthread_create(&lanes[i].thread, NULL,
+						   snapshot_lane_run,
+						   &lanes[i]);
+	}
+
+	for (i = 0; i < SNAPSHOT_LANE_MAX; i++) {
+		if (lanes[i].started)
+			pthread_join(lanes[i].thread, NULL);
+		else
+			snapshot_lane_run(&lanes[i]);
+
+		for (j = 0; j < COUNTER_MAX; j++)
+			counters[j] += lanes[i].ctx->counters[j];
+		mosys_ctx_free(lanes[i].ctx);
+	}
+
+	if (!mosys_get_keep_devices_open()) {
+		for (i = 0; i < ARRAY_SIZE(ecs); i++) {
+			if (ecs[i] && ecs[i]->destroy)
+				ecs[i]->destroy(ecs[i]);
+		}
+	}
+
+	for (i = 0; i < ARRAY_SIZE(results); i++) {
+		for (j = 0; j < results[i].count; j++) {
+			kv_pair_print(results[i].records[j]);
+			kv_pair_free(results[i].records[j]);
+		}
+		free(results[i].records);
+
+		/* sections the platform does not have are left out */
+		if (results[i].rc < 0 && results[i].errsv != ENOSYS) {
+			lprintf(LOG_ERR, "Unable to collect %s information\n",
+				results[i].section);
+			rc = -1;
+			errsv = results[i].errsv;
+		}
+	}
+
+	errno = errsv;
+	return rc;
+}
+
+struct platform_cmd cmd_snapshot = {
+	.name	= "snapshot",
+	.desc	= "Print platform, memory, EC, PSU and eventlog information",
+	.type	= ARG_TYPE_GETTER,
+	.flags	= CMD_FLAG_LIST,
+	.arg	= { .func = snapshot_cmd }
+};
@@ -0,0 +1,101 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * context.c: per-invocation state
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mosys/alloc.h"
+#include "mosys/context.h"
+#include "mosys/output.h"
+
+static struct mosys_ctx mosys_default_ctx;
+static __thread struct mosys_ctx *mosys_current_ctx;
+
+struct mosys_ctx *mosys_ctx_get(void)
+{
+	return mosys_current_ctx ? : &mosys_default_ctx;
+}
+
+struct mosys_ctx *mosys_ctx_set(struct mosys_ctx *ctx)
+{
+	struct mosys_ctx *prev = mosys_ctx_get();
+
+	mosys_current_ctx = ctx;
+	return prev;
+}
+
+struct mosys_ctx *mosys_ctx_new(void)
+{
+	struct mosys_ctx *parent = mosys_ctx_get();
+	struct mosys_ctx *ctx = mosys_zalloc(sizeof(*ctx));
+
+	ctx->log_name = parent->log_name;
+	ctx->log_threshold = parent->log_threshold;
+	ctx->log_outfile = parent->log_outfile;
+	ctx->log_valid = parent->log_valid;
+	ctx->log_flush_level = parent->log_flush_level;
+	ctx->output_file = parent->output_file;
+	ctx->verbosity = parent->verbosity;
+	ctx->kv_style = parent->kv_style;
+	ctx->kv_single_key = parent->kv_single_key;
+	ctx->keep_devices_open = parent->keep_devices_open;
+	ctx->use_platform_cache = parent->use_platform_cache;
+
+	return ctx;
+}
+
+void mosys_ctx_free(struct mosys_ctx *ctx)
+{
+	struct mosys_ctx *prev;
+	int i;
+
+	if (!ctx)
+		return;
+
+	prev = mosys_ctx_set(ctx);
+	mosys_output_flush();
+	log_flush();
+	mosys_ctx_set(prev);
+	free(ctx->out_buf);
+	free(ctx->log_buf);
+	free(ctx->log_ring);
+
+	for (i = 0; i < ctx->i2c_handle_num; i++) {
+		if (ctx->i2c_handles[i].fd >= 0)
+			close(ctx->i2c_handles[i].fd);
+	}
+	for (i = 0; i < ctx->spd_device_num; i++)
+		free(ctx->spd_devices[i]);
+	free(ctx->spd_devices);
+	mosys_arena_free(ctx->cmd_arena);
+	mosys_arena_free(ctx->arena);
+	free(ctx);
+}
+
+struct mosys_arena *mosys_ctx_arena(void)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	if (!ctx->arena)
+		ctx->arena = mosys_arena_new();
+	return ctx->arena;
+}
+
+struct mosys_arena *mosys_cmd_arena(void)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	if (!ctx->cmd_arena)
+		ctx->cmd_arena = mosys_arena_new();
+	return ctx->cmd_arena;
+}
+
+uint64_t *mosys_ctx_counters(void)
+{
+	return mosys_ctx_get()->counters;
+}
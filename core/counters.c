@@ -0,0 +1,53 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * counters.c: I/O accounting counters
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "mosys/counters.h"
+#include "mosys/log.h"
+
+static const char *counter_names[COUNTER_MAX] = {
+	[COUNTER_FILES_OPENED]	= "files_opened",
+	[COUNTER_BYTES_READ]	= "bytes_read",
+	[COUNTER_MMIO_MAPS]	= "mmio_maps",
+	[COUNTER_I2C_OPS]	= "i2c_ops",
+	[COUNTER_EC_COMMANDS]	= "ec_commands",
+	[COUNTER_CHILD_PROCS]	= "child_procs",
+};
+
+void counters_reset(void)
+{
+	uint64_t *counters = mosys_ctx_counters();
+
+	memset(counters, 0, COUNTER_MAX * sizeof(*counters));
+}
+
+void counters_report(const char *label, int machine)
+{
+	uint64_t *counters = mosys_ctx_counters();
+	char buf[256] = "";
+	size_t len = 0;
+	int i;
+
+	for (i = 0; i < COUNTER_MAX; i++) {
+		int n = snprintf(buf + len, sizeof(buf) - len,
+				 " %s=\"%" PRIu64 "\"",
+				 counter_names[i], counters[i]);
+
+		if (n < 0 || n >= sizeof(buf) - len)
+			break;
+		len += n;
+	}
+
+	if (machine)
+		fprintf(log_outfile_get(), "counters=\"%s\"%s\n", label, buf);
+	else
+		lprintf(LOG_NOTICE, "I/O for \"%s\":%s\n", label, buf);
+}
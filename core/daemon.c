@@ -0,0 +1,513 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * daemon.c: serve mosys commands over a Unix socket
+ *
+ * The wire protocol is deliberately simple, with one request per
+ * connection.  The client sends a 32-bit length followed by its argv
+ * strings, each terminated by a NUL byte.  The daemon answers with a
+ * 32-bit exit status, 32-bit response flags, the 32-bit lengths of the
+ * captured output and log text, and then the two buffers.  All integers
+ * are in host byte order, since both ends always run on the same machine.
+ *
+ * The socket is only accessible to its owner, and connections from any
+ * other user than root or the daemon's own are refused.
+ */
+
+#define _GNU_SOURCE /* for struct ucred */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "mosys/alloc.h"
+#include "mosys/cli.h"
+#include "mosys/daemon.h"
+#include "mosys/globals.h"
+#include "mosys/kv_pair.h"
+#include "mosys/log.h"
+#include "mosys/platform.h"
+
+#include "lib/math.h"
+
+/* Response flag telling the client to run the command itself */
+#define MOSYSD_RESPONSE_FALLBACK	(1 << 0)
+
+#define MOSYSD_MAX_ARGS		64
+
+/* How long a client may take to send its request or read the reply */
+#define MOSYSD_IO_TIMEOUT_SECS	5
+
+struct daemon_response {
+	int32_t status;
+	uint32_t flags;
+	uint32_t out_len;
+	uint32_t err_len;
+} __attribute__((packed));
+
+/*
+ * Cached results of boot-constant commands, keyed by the raw request
+ * without argv[0], so that the same command reaches the same entry
+ * however the client binary was invoked.
+ */
+struct daemon_cache_entry {
+	char *request;
+	uint32_t request_len;
+	struct daemon_response hdr;
+	char *out;
+	char *err;
+	struct daemon_cache_entry *next;
+};
+
+static struct daemon_cache_entry *daemon_cache;
+
+static volatile sig_atomic_t daemon_stop;
+
+static void daemon_signal(int sig)
+{
+	daemon_stop = 1;
+}
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+	const char *p = buf;
+
+	while (len) {
+		ssize_t n = write(fd, p, len);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return -1;
+		p += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+static int read_all(int fd, void *buf, size_t len)
+{
+	char *p = buf;
+
+	while (len) {
+		ssize_t n = read(fd, p, len);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return -1;
+		p += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+static int send_response(int conn, const struct daemon_response *hdr,
+			 const char *out, const char *err)
+{
+	if (write_all(conn, hdr, sizeof(*hdr)) < 0 ||
+	    write_all(conn, out, hdr->out_len) < 0 ||
+	    write_all(conn, err, hdr->err_len) < 0)
+		return -1;
+	return 0;
+}
+
+static int send_fallback(int conn)
+{
+	struct daemon_response hdr = {
+		.flags = MOSYSD_RESPONSE_FALLBACK,
+	};
+
+	return send_response(conn, &hdr, NULL, NULL);
+}
+
+static struct daemon_cache_entry *cache_find(const char *request,
+					     uint32_t len)
+{
+	struct daemon_cache_entry *ent;
+
+	for (ent = daemon_cache; ent; ent = ent->next) {
+		if (ent->request_len == len &&
+		    !memcmp(ent->request, request, len))
+			return ent;
+	}
+
+	return NULL;
+}
+
+static void cache_add(const char *request, uint32_t len,
+		      const struct daemon_response *hdr,
+		      const char *out, const char *err)
+{
+	struct daemon_cache_entry *ent = mosys_zalloc(sizeof(*ent));
+
+	ent->request = mosys_malloc(len);
+	memcpy(ent->request, request, len);
+	ent->request_len = len;
+	ent->hdr = *hdr;
+	ent->out = mosys_malloc(hdr->out_len + 1);
+	memcpy(ent->out, out, hdr->out_len);
+	ent->err = mosys_malloc(hdr->err_len + 1);
+	memcpy(ent->err, err, hdr->err_len);
+
+	ent->next = daemon_cache;
+	daemon_cache = ent;
+}
+
+static void cache_free(void)
+{
+	struct daemon_cache_entry *ent, *next;
+
+	for (ent = daemon_cache; ent; ent = next) {
+		next = ent->next;
+		free(ent->request);
+		free(ent->out);
+		free(ent->err);
+		free(ent);
+	}
+	daemon_cache = NULL;
+}
+
+/*
+ * daemon_run  -  run one request with its output and log captured
+ *
+ * @intf:	platform interface
+ * @argc:	argument count, including argv[0]
+ * @argv:	argument vector
+ * @hdr:	response header to fill in
+ * @out:	set to the allocated output text
+ * @err:	set to the allocated log text
+ * @cmd:	set to the command that was resolved, if any
+ *
+ * returns 0 if the request was run
+ * returns <0 if the client should run the command itself
+ */
+static int daemon_run(struct platform_intf *intf, int argc, char **argv,
+		      struct daemon_response *hdr, char **out, char **err,
+		      struct platform_cmd **cmd)
+{
+	enum kv_pair_style saved_style = mosys_get_kv_pair_style();
+	const char *saved_key = kv_get_single_key();
+	int saved_verbosity = mosys_get_verbosity();
+	FILE *saved_out = mosys_get_output_file();
+	FILE *saved_log = log_outfile_get();
+	enum kv_pair_style style = KV_STYLE_VALUE;
+	int verbose = LOG_ERR;
+	size_t out_len, err_len;
+	FILE *out_fp, *err_fp;
+	int argflag;
+
+	hdr->flags = 0;
+
+	/* Only options which affect formatting can be honored here. */
+	optind = 0;
+	opterr = 0;
+	while ((argflag = getopt(argc, argv, "+kljCvs:")) > 0) {
+		switch (argflag) {
+		case 'k':
+			style = KV_STYLE_PAIR;
+			break;
+		case 'l':
+			style = KV_STYLE_LONG;
+			break;
+		case 'j':
+			style = KV_STYLE_JSON;
+			break;
+		case 'C':
+			style = KV_STYLE_CBOR;
+			break;
+		case 's':
+			style = KV_STYLE_SINGLE;
+			kv_set_single_key(optarg);
+			break;
+		case 'v':
+			verbose++;
+			break;
+		default:
+			kv_set_single_key(saved_key);
+			return -1;
+		}
+	}
+
+	*cmd = platform_find_cmd(intf, argc - optind, argv + optind);
+
+	out_fp = open_memstream(out, &out_len);
+	err_fp = open_memstream(err, &err_len);
+	if (!out_fp || !err_fp) {
+		if (out_fp)
+			fclose(out_fp);
+		if (err_fp)
+			fclose(err_fp);
+		kv_set_single_key(saved_key);
+		return -1;
+	}
+
+	mosys_set_kv_pair_style(style);
+	mosys_set_verbosity(verbose);
+	log_threshold_set(verbose);
+	mosys_set_output_file(out_fp);
+	log_outfile_set(err_fp);
+
+	hdr->status = mosys_run_cmd(intf, argc - optind, argv + optind);
+
+	mosys_set_output_file(saved_out);
+	log_outfile_set(saved_log);
+	log_threshold_set(saved_verbosity);
+	mosys_set_verbosity(saved_verbosity);
+	mosys_set_kv_pair_style(saved_style);
+	kv_set_single_key(saved_key);
+
+	fclose(out_fp);
+	fclose(err_fp);
+	hdr->out_len = out_len;
+	hdr->err_len = err_len;
+
+	return 0;
+}
+
+static int daemon_handle(struct platform_intf *intf, int conn)
+{
+	char request[MOSYSD_MAX_REQUEST];
+	char *argv[MOSYSD_MAX_ARGS + 1];
+	struct daemon_cache_entry *ent;
+	struct daemon_response hdr;
+	struct platform_cmd *cmd;
+	char *out = NULL, *err = NULL;
+	uint32_t len, pos, key;
+	int argc = 0, rc;
+
+	if (read_all(conn, &len, sizeof(len)) < 0)
+		return -1;
+	if (len == 0 || len > sizeof(request)) {
+		lprintf(LOG_WARNING, "%s: Bad request length %u\n",
+			__func__, len);
+		return send_fallback(conn);
+	}
+	if (read_all(conn, request, len) < 0)
+		return -1;
+	if (request[len - 1] != '\0')
+		return send_fallback(conn);
+
+	/* Leave argv[0] out of the cache key. */
+	key = strlen(request) + 1;
+
+	ent = cache_find(&request[key], len - key);
+	if (ent) {
+		lprintf(LOG_DEBUG, "%s: Answering from cache\n", __func__);
+		return send_response(conn, &ent->hdr, ent->out, ent->err);
+	}
+
+	for (pos = 0; pos < len; pos += strlen(&request[pos]) + 1) {
+		if (argc == MOSYSD_MAX_ARGS)
+			return send_fallback(conn);
+		argv[argc++] = &request[pos];
+	}
+	argv[argc] = NULL;
+
+	if (daemon_run(intf, argc, argv, &hdr, &out, &err, &cmd) < 0)
+		return send_fallback(conn);
+
+	if (hdr.status == 0 && cmd && (cmd->flags & CMD_FLAG_BOOT_CONSTANT))
+		cache_add(&request[key], len - key, &hdr, out, err);
+
+	rc = send_response(conn, &hdr, out, err);
+	free(out);
+	free(err);
+	return rc;
+}
+
+/*
+ * daemon_accept_peer  -  check and prepare an accepted connection
+ *
+ * @conn:	connected socket
+ *
+ * Only root and the user running the daemon may send requests.  The
+ * connection gets send and receive timeouts so that a client which
+ * stops talking cannot hold up the requests queued behind it.
+ *
+ * returns 0 if the connection may be served
+ * returns <0 if it should be closed
+ */
+static int daemon_accept_peer(int conn)
+{
+	struct timeval tv = { .tv_sec = MOSYSD_IO_TIMEOUT_SECS };
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+
+	if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) {
+		lperror(LOG_ERR, "Unable to get peer credentials");
+		return -1;
+	}
+	if (cred.uid != 0 && cred.uid != geteuid()) {
+		lprintf(LOG_WARNING, "Refusing request from uid %u\n",
+			(unsigned int)cred.uid);
+		return -1;
+	}
+
+	if (setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0 ||
+	    setsockopt(conn, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) < 0) {
+		lperror(LOG_ERR, "Unable to set socket timeouts");
+		return -1;
+	}
+
+	return 0;
+}
+
+static void daemon_release_ecs(struct platform_intf *intf)
+{
+	struct ec_cb *ecs[3];
+	int i;
+
+	if (!intf->cb)
+		return;
+
+	ecs[0] = intf->cb->ec;
+	ecs[1] = intf->cb->pd;
+	ecs[2] = intf->cb->fp;
+	for (i = 0; i < ARRAY_SIZE(ecs); i++) {
+		if (ecs[i] && ecs[i]->destroy)
+			ecs[i]->destroy(ecs[i]);
+	}
+}
+
+int mosys_daemon_serve(struct platform_intf *intf, const char *path)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	struct sigaction sa = { .sa_handler = daemon_signal };
+	mode_t old_umask;
+	int sock, rc = 0;
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		lprintf(LOG_ERR, "Socket path %s is too long\n", path);
+		return -1;
+	}
+	strcpy(addr.sun_path, path);
+
+	sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (sock < 0) {
+		lperror(LOG_ERR, "Unable to create socket");
+		return -1;
+	}
+
+	/* A previous instance may have left its socket behind. */
+	unlink(path);
+
+	/* Create the socket accessible to its owner only. */
+	old_umask = umask(0177);
+	rc = bind(sock, (struct sockaddr *)&addr, sizeof(addr));
+	umask(old_umask);
+	if (rc < 0 || listen(sock, 16) < 0) {
+		lperror(LOG_ERR, "Unable to listen on %s", path);
+		close(sock);
+		return -1;
+	}
+
+	/* No SA_RESTART, so that accept() is interrupted by the signals. */
+	sigaction(SIGTERM, &sa, NULL);
+	sigaction(SIGINT, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	mosys_set_keep_devices_open(1);
+	lprintf(LOG_NOTICE, "Serving requests on %s\n", path);
+
+	while (!daemon_stop) {
+		int conn = accept(sock, NULL, NULL);
+
+		if (conn < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			lperror(LOG_ERR, "accept() failed");
+			rc = -1;
+			break;
+		}
+
+		if (daemon_accept_peer(conn) < 0)
+			lprintf(LOG_DEBUG, "Dropping connection\n");
+		else if (daemon_handle(intf, conn) < 0)
+			lprintf(LOG_DEBUG, "Client went away\n");
+		close(conn);
+	}
+
+	mosys_set_keep_devices_open(0);
+	daemon_release_ecs(intf);
+	cache_free();
+	close(sock);
+	unlink(path);
+
+	return rc;
+}
+
+static int relay(int fd, FILE *fp, uint32_t len)
+{
+	char buf[4096];
+
+	while (len) {
+		uint32_t n = __min(len, sizeof(buf));
+
+		if (read_all(fd, buf, n) < 0)
+			return -1;
+		fwrite(buf, 1, n, fp);
+		len -= n;
+	}
+
+	fflush(fp);
+	return 0;
+}
+
+int mosys_daemon_request(const char *path, int argc, char **argv)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	char request[MOSYSD_MAX_REQUEST];
+	struct daemon_response hdr;
+	uint32_t len = 0;
+	int sock, i, rc = -1;
+
+	if (strlen(path) >= sizeof(addr.sun_path))
+		return -1;
+	strcpy(addr.sun_path, path);
+
+	for (i = 0; i < argc; i++) {
+		size_t n = strlen(argv[i]) + 1;
+
+		if (len + n > sizeof(request))
+			return -1;
+		memcpy(&request[len], argv[i], n);
+		len += n;
+	}
+
+	sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (sock < 0)
+		return -1;
+
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+		goto out;
+
+	if (write_all(sock, &len, sizeof(len)) < 0 ||
+	    write_all(sock, request, len) < 0)
+		goto out;
+
+	if (read_all(sock, &hdr, sizeof(hdr)) < 0 ||
+	    (hdr.flags & MOSYSD_RESPONSE_FALLBACK))
+		goto out;
+
+	if (relay(sock, stdout, hdr.out_len) < 0 ||
+	    relay(sock, stderr, hdr.err_len) < 0)
+		goto out;
+
+	rc = hdr.status & 0xff;
+out:
+	close(sock);
+	return rc;
+}
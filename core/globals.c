@@ -27,45 +27,83 @@
  * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *
- * globals.c: all global variables are declared here.
+ * globals.c: accessors for settings kept in the current context.
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 
+#include "mosys/context.h"
 #include "mosys/globals.h"
+#include "mosys/log.h"
+#include "mosys/output.h"
+
+static void flush_output(void)
+{
+	mosys_output_flush();
+	log_flush();
+}
 
 void mosys_globals_init() {
 	mosys_set_output_file(stdout);
+	atexit(flush_output);
 }
 
 /*
- * The global output destination
+ * The output destination
  */
-static FILE *mosys_output_file;
-
 FILE *mosys_get_output_file(void)
 {
-	if (!mosys_output_file)
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	if (!ctx->output_file)
 		return stdout;
-	return mosys_output_file;
+	return ctx->output_file;
 }
 
 void mosys_set_output_file(FILE *fp)
 {
-	mosys_output_file = fp;
+	/* buffered output belongs to the old file */
+	if ((fp ? : stdout) != mosys_get_output_file())
+		mosys_output_flush();
+	mosys_ctx_get()->output_file = fp;
 }
 
 /*
- * The global verbosity level
+ * The verbosity level
  */
-static int mosys_verbosity;
-
 int mosys_get_verbosity(void)
 {
-	return mosys_verbosity;
+	return mosys_ctx_get()->verbosity;
 }
 
 void mosys_set_verbosity(int verbosity)
 {
-	mosys_verbosity = verbosity;
+	mosys_ctx_get()->verbosity = verbosity;
+}
+
+/*
+ * Whether devices stay open between commands (e.g. in daemon mode)
+ */
+int mosys_get_keep_devices_open(void)
+{
+	return mosys_ctx_get()->keep_devices_open;
+}
+
+void mosys_set_keep_devices_open(int keep)
+{
+	mosys_ctx_get()->keep_devices_open = keep;
+}
+
+/*
+ * Whether platform probing results are cached for the rest of the boot
+ */
+int mosys_get_use_platform_cache(void)
+{
+	return mosys_ctx_get()->use_platform_cache;
+}
+
+void mosys_set_use_platform_cache(int use)
+{
+	mosys_ctx_get()->use_platform_cache = use;
 }
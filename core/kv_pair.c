@@ -41,25 +41,53 @@
 #include <sys/file.h>
 
 #include "mosys/alloc.h"
+#include "mosys/context.h"
 #include "mosys/globals.h"
 #include "mosys/kv_pair.h"
-
-/*
- * globally used kv_pair_style
- */
-static enum kv_pair_style mosys_kv_pair_style;
+#include "mosys/output.h"
+#include "mosys/trace.h"
 
 void mosys_set_kv_pair_style(enum kv_pair_style style)
 {
-	mosys_kv_pair_style = style;
+	mosys_ctx_get()->kv_style = style;
 }
 
 enum kv_pair_style mosys_get_kv_pair_style()
 {
-	return mosys_kv_pair_style;
+	return mosys_ctx_get()->kv_style;
 }
 
 
+/*
+ * A record is one allocation holding the header, room for the first
+ * fields and an arena for their values, so that building a typical
+ * record (an eventlog entry, a DIMM) takes a single malloc.  Fields and
+ * arena move to the heap if a record outgrows them.  Values, and keys
+ * added with KV_PAIR_COPY_KEY, are kept as offsets into the arena so the
+ * arena can be moved.
+ */
+#define KV_PAIR_INLINE_FIELDS	12
+#define KV_PAIR_INLINE_ARENA	256
+
+struct kv_field {
+	const char *key;	/* NULL if the key was copied to the arena */
+	unsigned int key_off;	/* offset of a copied key */
+	unsigned int value_off;	/* offset of the value */
+	enum kv_type type;
+	int64_t num;		/* value of integer and boolean fields */
+};
+
+struct kv_pair {
+	struct kv_field *fields;
+	int count;
+	int max;
+	char *arena;
+	size_t used;
+	size_t size;
+	struct kv_field inline_fields[KV_PAIR_INLINE_FIELDS];
+	char inline_arena[KV_PAIR_INLINE_ARENA];
+};
+
 /*
  * kv_pair_new  -  create new key=value pair
  *
@@ -67,45 +95,109 @@ enum kv_pair_style mosys_get_kv_pair_style()
  */
 struct kv_pair *kv_pair_new(void)
 {
-	struct kv_pair *kv = mosys_zalloc(sizeof(*kv));
+	struct kv_pair *kv = mosys_malloc(sizeof(*kv));
+
+	kv->fields = kv->inline_fields;
+	kv->count = 0;
+	kv->max = KV_PAIR_INLINE_FIELDS;
+	kv->arena = kv->inline_arena;
+	kv->used = 0;
+	kv->size = KV_PAIR_INLINE_ARENA;
 	return kv;
 }
 
+/* make room for @len more bytes in the arena */
+static void kv_pair_reserve(struct kv_pair *kv, size_t len)
+{
+	size_t size = kv->size;
+
+	if (kv->used + len <= size)
+		return;
+
+	while (kv->used + len > size)
+		size *= 2;
+
+	if (kv->arena == kv->inline_arena) {
+		kv->arena = mosys_malloc(size);
+		memcpy(kv->arena, kv->inline_arena, kv->used);
+	} else {
+		kv->arena = mosys_realloc(kv->arena, size);
+	}
+	kv->size = size;
+}
+
+/* copy a string to the arena, returning its offset */
+static unsigned int kv_pair_store(struct kv_pair *kv, const char *str)
+{
+	size_t len = strlen(str) + 1;
+	unsigned int off = kv->used;
+
+	kv_pair_reserve(kv, len);
+	memcpy(kv->arena + off, str, len);
+	kv->used += len;
+	return off;
+}
+
+/* append a field, the caller fills in the value */
+static struct kv_field *kv_pair_append_field(struct kv_pair *kv,
+					     const char *key,
+					     unsigned int flags)
+{
+	struct kv_field *field;
+
+	if (kv->count == kv->max) {
+		kv->max *= 2;
+		if (kv->fields == kv->inline_fields) {
+			kv->fields = mosys_malloc(kv->max * sizeof(*field));
+			memcpy(kv->fields, kv->inline_fields,
+			       kv->count * sizeof(*field));
+		} else {
+			kv->fields = mosys_realloc(kv->fields,
+						   kv->max * sizeof(*field));
+		}
+	}
+
+	field = &kv->fields[kv->count++];
+	field->type = KV_TYPE_STRING;
+	field->num = 0;
+	if (flags & KV_PAIR_COPY_KEY) {
+		field->key = NULL;
+		field->key_off = kv_pair_store(kv, key);
+	} else {
+		field->key = key;
+		field->key_off = 0;
+	}
+
+	return field;
+}
+
+struct kv_pair *kv_pair_add_flags(struct kv_pair *kv_list, const char *key,
+				  const char *value, unsigned int flags)
+{
+	struct kv_field *field;
+
+	/* a pair without key or value would never be printed */
+	if (!kv_list || !key || !value)
+		return kv_list;
+
+	field = kv_pair_append_field(kv_list, key, flags);
+	field->value_off = kv_pair_store(kv_list, value);
+	return kv_list;
+}
+
 /*
  * kv_pair_add  -  add new key=value pair to list
  *
  * @kv_list:    key=value pair list
- * @key:        key string
+ * @key:        key string, kept by reference
  * @value:      value string
  *
- * returns pointer to new key=value pair
- * returns NULL to indicate error
+ * returns @kv_list
  */
 struct kv_pair *kv_pair_add(struct kv_pair *kv_list,
 			    const char *key, const char *value)
 {
-	struct kv_pair *kv_new = kv_pair_new();
-	struct kv_pair *kv_ptr;
-
-	/* save key=value strings if provided */
-	if (key) {
-		kv_new->key = mosys_strdup(key);
-	}
-	if (value) {
-		kv_new->value = mosys_strdup(value);
-	}
-
-	/* first in the list if no list provided */
-	if (kv_list) {
-		/* find the end of list */
-		for (kv_ptr = kv_list; kv_ptr->next != NULL; kv_ptr = kv_ptr->next) ;
-
-		/* link in the new pair at the end */
-		kv_ptr->next = kv_new;
-	}
-
-	/* return pointer to the new pair */
-	return kv_new;
+	return kv_pair_add_flags(kv_list, key, value, 0);
 }
 
 /*
@@ -115,20 +207,56 @@ struct kv_pair *kv_pair_add(struct kv_pair *kv_list,
  * @key:        key string
  * @value:      value
  *
- * returns pointer to new key=value pair
- * returns NULL to indicate error
+ * returns @kv_list
  */
 struct kv_pair *kv_pair_add_bool(struct kv_pair *kv_list,
                                  const char *key, int value)
 {
 	const char *str;
+	int count = kv_pair_count(kv_list);
 
 	if (value) {
 		str = "yes";
 	} else {
 		str = "no";
 	}
-	return kv_pair_add(kv_list, key, str);
+	kv_pair_add(kv_list, key, str);
+	if (kv_pair_count(kv_list) > count) {
+		kv_list->fields[count].type = KV_TYPE_BOOL;
+		kv_list->fields[count].num = !!value;
+	}
+
+	return kv_list;
+}
+
+/* add a pair with a formatted value, the value is formatted in place */
+static struct kv_field *kv_pair_vfmt(struct kv_pair *kv_list,
+				     const char *kv_key, const char *format,
+				     va_list vptr)
+{
+	struct kv_field *field;
+	va_list aq;
+	int len;
+
+	field = kv_pair_append_field(kv_list, kv_key, 0);
+	field->value_off = kv_list->used;
+
+	va_copy(aq, vptr);
+	len = vsnprintf(kv_list->arena + kv_list->used,
+			kv_list->size - kv_list->used, format, aq);
+	va_end(aq);
+
+	if (len < 0)
+		len = 0;
+	if (kv_list->used + len + 1 > kv_list->size) {
+		kv_pair_reserve(kv_list, len + 1);
+		vsnprintf(kv_list->arena + kv_list->used, len + 1, format,
+			  vptr);
+	}
+	kv_list->arena[kv_list->used + len] = '\0';
+	kv_list->used += len + 1;
+
+	return field;
 }
 
 /*
@@ -139,22 +267,114 @@ struct kv_pair *kv_pair_add_bool(struct kv_pair *kv_list,
  * @format:     printf-style format for value input
  * @...:        arguments to format
  *
- * returns pointer to new key=value pair
- * returns NULL to indicate error
+ * The value is formatted straight into the record.
+ *
+ * returns @kv_list
  */
 struct kv_pair *kv_pair_fmt(struct kv_pair *kv_list,
 			    const char *kv_key, const char *format, ...)
 {
-	char kv_value[KV_PAIR_MAX_VALUE_LEN];
 	va_list vptr;
 
-	memset(kv_value, 0, sizeof(kv_value));
+	if (!kv_list || !kv_key)
+		return kv_list;
 
 	va_start(vptr, format);
-	vsnprintf(kv_value, sizeof(kv_value), format, vptr);
+	kv_pair_vfmt(kv_list, kv_key, format, vptr);
 	va_end(vptr);
 
-	return kv_pair_add(kv_list, kv_key, kv_value);
+	return kv_list;
+}
+
+/*
+ * kv_pair_fmt_int  -  add integer key=value pair with printf formatted text
+ *
+ * @kv_list:    list of key=value pairs
+ * @kv_key:     key string
+ * @num:        value, for output styles which keep integers
+ * @format:     printf-style format for the value in text output styles
+ * @...:        arguments to format
+ *
+ * returns @kv_list
+ */
+struct kv_pair *kv_pair_fmt_int(struct kv_pair *kv_list, const char *kv_key,
+				int64_t num, const char *format, ...)
+{
+	struct kv_field *field;
+	va_list vptr;
+
+	if (!kv_list || !kv_key)
+		return kv_list;
+
+	va_start(vptr, format);
+	field = kv_pair_vfmt(kv_list, kv_key, format, vptr);
+	va_end(vptr);
+
+	field->type = KV_TYPE_INT;
+	field->num = num;
+
+	return kv_list;
+}
+
+struct kv_pair *kv_pair_add_int(struct kv_pair *kv_list, const char *key,
+				int64_t num)
+{
+	return kv_pair_fmt_int(kv_list, key, num, "%" PRId64, num);
+}
+
+struct kv_pair *kv_pair_append(struct kv_pair *kv_list,
+			       const struct kv_pair *src)
+{
+	int i;
+
+	for (i = 0; i < src->count; i++) {
+		kv_pair_add_flags(kv_list, kv_pair_key(src, i),
+				  kv_pair_value(src, i),
+				  src->fields[i].key ? 0 : KV_PAIR_COPY_KEY);
+		kv_list->fields[kv_list->count - 1].type = src->fields[i].type;
+		kv_list->fields[kv_list->count - 1].num = src->fields[i].num;
+	}
+
+	return kv_list;
+}
+
+int kv_pair_count(const struct kv_pair *kv_list)
+{
+	return kv_list ? kv_list->count : 0;
+}
+
+const char *kv_pair_key(const struct kv_pair *kv_list, int i)
+{
+	const struct kv_field *field = &kv_list->fields[i];
+
+	return field->key ? field->key : kv_list->arena + field->key_off;
+}
+
+const char *kv_pair_value(const struct kv_pair *kv_list, int i)
+{
+	return kv_list->arena + kv_list->fields[i].value_off;
+}
+
+enum kv_type kv_pair_type(const struct kv_pair *kv_list, int i)
+{
+	return kv_list->fields[i].type;
+}
+
+int64_t kv_pair_int(const struct kv_pair *kv_list, int i)
+{
+	return kv_list->fields[i].num;
+}
+
+const char *kv_pair_get(const struct kv_pair *kv_list, const char *key)
+{
+	int i;
+
+	for (i = 0; i < kv_pair_count(kv_list); i++) {
+		if (!strcmp(kv_pair_key(kv_list, i), key))
+			return kv_pair_value(kv_list, i);
+	}
+
+	return NULL;
 }
 
 /*
@@ -164,89 +384,252 @@ struct kv_pair *kv_pair_fmt(struct kv_pair *kv_list,
  */
 void kv_pair_free(struct kv_pair *kv_list)
 {
-	struct kv_pair *kv_ptr = kv_list;
-	struct kv_pair *kv_next;
+	if (!kv_list)
+		return;
+
+	if (kv_list->fields != kv_list->inline_fields)
+		free(kv_list->fields);
+	if (kv_list->arena != kv_list->inline_arena)
+		free(kv_list->arena);
+	free(kv_list);
+}
+
+/*
+ * key_list_find  -  find a key in a comma-separated list of keys
+ *
+ * @keys:	comma-separated list of keys
+ * @key:	key to look for
+ * @len:	length of @key
+ *
+ * returns 1 if @key is in @keys
+ * returns 0 otherwise
+ */
+static int key_list_find(const char *keys, const char *key, size_t len)
+{
+	size_t n;
+
+	for (; *keys; keys += n + !!keys[n]) {
+		n = strcspn(keys, ",");
+		if (n == len && !strncmp(keys, key, len))
+			return 1;
+	}
+
+	return 0;
+}
+
+int kv_key_wanted(const char *key)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	if (ctx->kv_style != KV_STYLE_SINGLE || !ctx->kv_single_key || !key)
+		return 1;
 
-	while (kv_ptr != NULL) {
-		/* free key/value strings */
-		if (kv_ptr->key)
-			free(kv_ptr->key);
-		if (kv_ptr->value)
-			free(kv_ptr->value);
+	return key_list_find(ctx->kv_single_key, key, strlen(key));
+}
 
-		/* free current pair move to next */
-		kv_next = kv_ptr->next;
-		free(kv_ptr);
-		kv_ptr = kv_next;
+int kv_any_key_wanted(const char *const *keys)
+{
+	for (; *keys; keys++) {
+		if (kv_key_wanted(*keys))
+			return 1;
 	}
+
+	return 0;
 }
 
 /*
- * kv_pair_print_to_file  -  print a key=value pair list
+ * kv_pair_print_single  -  print the values of the keys given with -s
  *
- * @kv_list:    pointer to key=value list
- * @style:      print style
+ * @fp:		file to print to
+ * @kv_list:	pointer to key=value list
+ *
+ * Values are printed in the order the keys were given, separated by
+ * " | " like KV_STYLE_VALUE.
  *
  * returns 0 to indicate success
- * returns <0 to indicate failure
+ * returns <0 if the list has none of the keys
  */
-int kv_pair_print_to_file(FILE* fp, struct kv_pair *kv_list,
-		enum kv_pair_style style)
+static int kv_pair_print_single(struct kv_pair *kv_list)
 {
-	struct kv_pair *kv_ptr;
-	int single_found = 0;
+	const char *keys = kv_get_single_key();
+	const char *key, *value;
+	int i, found = 0;
+	size_t n;
+
+	if (!keys)
+		return -1;
 
-	for (kv_ptr = kv_list; kv_ptr != NULL; kv_ptr = kv_ptr->next) {
-		if (!kv_ptr->key || !kv_ptr->value)
+	for (; *keys; keys += n + !!keys[n]) {
+		n = strcspn(keys, ",");
+
+		for (i = 0; i < kv_list->count; i++) {
+			key = kv_pair_key(kv_list, i);
+			if (strlen(key) == n && !strncmp(key, keys, n))
+				break;
+		}
+		if (i == kv_list->count)
 			continue;
 
+		if (found)
+			mosys_write(" | ", 3);
+		value = kv_pair_value(kv_list, i);
+		mosys_write(value, strlen(value));
+		found = 1;
+	}
+
+	if (!found)
+		return -1;
+
+	return mosys_write("\n", 1);
+}
+
+/* print a key=value pair list as a JSON object */
+static int kv_pair_write_json(struct kv_pair *kv_list)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	int i, rc = 0;
+
+	if (ctx->kv_in_list && ctx->kv_list_records++)
+		rc |= mosys_write(",\n", 2);
+	else if (ctx->kv_in_list)
+		rc |= mosys_write("\n", 1);
+
+	rc |= mosys_write("{", 1);
+	for (i = 0; i < kv_list->count; i++) {
+		if (i)
+			rc |= mosys_write(",", 1);
+		rc |= mosys_write_json_string(kv_pair_key(kv_list, i));
+		rc |= mosys_write(":", 1);
+		rc |= mosys_write_json_string(kv_pair_value(kv_list, i));
+	}
+	rc |= mosys_write("}", 1);
+
+	/* records of a list are separated by the next one or the end */
+	if (!ctx->kv_in_list)
+		rc |= mosys_write("\n", 1);
+
+	return rc;
+}
+
+/* position of a key in a schema, or -1 */
+static int kv_schema_index(const struct kv_schema *schema, const char *key)
+{
+	int i;
+
+	for (i = 0; schema && schema[i].key; i++) {
+		if (schema[i].key == key || !strcmp(schema[i].key, key))
+			return i;
+	}
+
+	return -1;
+}
+
+/* print a key=value pair list as a CBOR map */
+static int kv_pair_write_cbor(struct kv_pair *kv_list)
+{
+	const struct kv_schema *schema = mosys_ctx_get()->kv_schema;
+	const char *key;
+	uint8_t simple;
+	int i, index, rc;
+
+	rc = mosys_write_cbor_head(CBOR_MAP, kv_list->count);
+	for (i = 0; i < kv_list->count; i++) {
+		key = kv_pair_key(kv_list, i);
+		index = kv_schema_index(schema, key);
+		if (index >= 0)
+			rc |= mosys_write_cbor_int(index);
+		else
+			rc |= mosys_write_cbor_string(key);
+
+		switch (kv_list->fields[i].type) {
+		case KV_TYPE_INT:
+			rc |= mosys_write_cbor_int(kv_list->fields[i].num);
+			break;
+		case KV_TYPE_BOOL:
+			simple = kv_list->fields[i].num ? CBOR_TRUE : CBOR_FALSE;
+			rc |= mosys_write(&simple, 1);
+			break;
+		case KV_TYPE_STRING:
+			rc |= mosys_write_cbor_string(kv_pair_value(kv_list, i));
+			break;
+		}
+	}
+
+	return rc;
+}
+
+/* print a key=value pair list to the buffered mosys output */
+static int kv_pair_write(struct kv_pair *kv_list, enum kv_pair_style style)
+{
+	const char *key, *value;
+	int i, last, rc = 0;
+	TRACE_SCOPE("output", "kv_pair_print");
+
+	if (style == KV_STYLE_SINGLE)
+		return kv_pair_print_single(kv_list);
+	if (style == KV_STYLE_JSON)
+		return kv_pair_write_json(kv_list);
+	if (style == KV_STYLE_CBOR)
+		return kv_pair_write_cbor(kv_list);
+
+	for (i = 0; i < kv_list->count; i++) {
+		key = kv_pair_key(kv_list, i);
+		value = kv_pair_value(kv_list, i);
+		last = i == kv_list->count - 1;
+
 		switch (style) {
-		case KV_STYLE_PAIR:{
-			int i, len = strlen(kv_ptr->value);
+		case KV_STYLE_PAIR:
 			/* need to escape quotes in value */
-			fprintf(fp, "%s=\"", kv_ptr->key);
-			for (i = 0; i < len; i++) {
-				if (kv_ptr->value[i] == '"')
-					fprintf(fp, "\\\"");
-				else
-					fprintf(fp, "%c", kv_ptr->value[i]);
-			}
-			fprintf(fp, "\" ");
+			rc |= mosys_write(key, strlen(key));
+			rc |= mosys_write("=\"", 2);
+			rc |= mosys_write_escaped(value, '"');
+			rc |= mosys_write("\" ", 2);
 			break;
-		}
 
 		case KV_STYLE_VALUE:
-			fprintf(fp, "%s", kv_ptr->value);
-			if (kv_ptr->next)
-				fprintf(fp, " | ");
+			rc |= mosys_write(value, strlen(value));
+			if (!last)
+				rc |= mosys_write(" | ", 3);
 			break;
 
 		case KV_STYLE_LONG:
-			fprintf(fp, "%-20s | %s", kv_ptr->key,
-                                       kv_ptr->value);
-			if (kv_ptr->next)
-				fprintf(fp, "\n");
+			if (mosys_printf("%-20s | %s", key, value) < 0)
+				rc = -1;
+			if (!last)
+				rc |= mosys_write("\n", 1);
 			break;
 
-		case KV_STYLE_SINGLE:{
-			const char *single_key = kv_get_single_key();
-			if (!single_key)
-				break;
-			if (!strncmp(single_key, kv_ptr->key,
-						strlen(kv_ptr->key))) {
-				fprintf(fp, "%s", kv_ptr->value);
-				single_found = 1;
-			}
+		case KV_STYLE_SINGLE:
+		case KV_STYLE_JSON:
+		case KV_STYLE_CBOR:
 			break;
 		}
-		}
 	}
 
-	if (style == KV_STYLE_SINGLE && !single_found)
-		return -1;
+	return rc | mosys_write("\n", 1);
+}
 
-	fprintf(fp, "\n");
-	return 0;
+/*
+ * kv_pair_print_to_file  -  print a key=value pair list
+ *
+ * @kv_list:    pointer to key=value list
+ * @style:      print style
+ *
+ * returns 0 to indicate success
+ * returns <0 to indicate failure
+ */
+int kv_pair_print_to_file(FILE* fp, struct kv_pair *kv_list,
+		enum kv_pair_style style)
+{
+	FILE *saved = mosys_get_output_file();
+	int rc;
+
+	/* output to another file is written out when switching back */
+	mosys_set_output_file(fp);
+	rc = kv_pair_write(kv_list, style);
+	mosys_set_output_file(saved);
+
+	return rc;
 }
 
 /*
@@ -259,19 +642,107 @@ int kv_pair_print_to_file(FILE* fp, struct kv_pair *kv_list,
  */
 int kv_pair_print(struct kv_pair *kv_list)
 {
-	FILE *fp = mosys_get_output_file();
-	enum kv_pair_style style = mosys_get_kv_pair_style();
-	return kv_pair_print_to_file(fp, kv_list, style);
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	int rc;
+
+	if (ctx->kv_sink) {
+		if (ctx->kv_sink_stopped)
+			return 0;
+		rc = ctx->kv_sink(kv_list, ctx->kv_sink_arg);
+		if (rc == KV_SINK_STOP) {
+			ctx->kv_sink_stopped = 1;
+			return 0;
+		}
+		return rc;
+	}
+
+	return kv_pair_write(kv_list, mosys_get_kv_pair_style());
+}
+
+static const char *const kv_type_names[] = {
+	[KV_TYPE_STRING]	= "string",
+	[KV_TYPE_INT]		= "int",
+	[KV_TYPE_BOOL]		= "bool",
+};
+
+void kv_pair_output_begin(const struct kv_schema *schema, int list)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	static const uint8_t records = CBOR_ARRAY_INDEFINITE;
+	int i, num = 0;
+
+	if (ctx->kv_sink || ctx->kv_in_list)
+		return;
+
+	switch (ctx->kv_style) {
+	case KV_STYLE_JSON:
+		if (!list)
+			return;
+		mosys_write("[", 1);
+		break;
+
+	case KV_STYLE_CBOR:
+		while (schema && schema[num].key)
+			num++;
+
+		mosys_write_cbor_head(CBOR_ARRAY, 2);
+		mosys_write_cbor_head(CBOR_ARRAY, num);
+		for (i = 0; i < num; i++) {
+			mosys_write_cbor_head(CBOR_ARRAY, 2);
+			mosys_write_cbor_string(schema[i].key);
+			mosys_write_cbor_string(kv_type_names[schema[i].type]);
+		}
+		mosys_write(&records, 1);
+		break;
+
+	default:
+		return;
+	}
+
+	ctx->kv_schema = schema;
+	ctx->kv_in_list = 1;
+	ctx->kv_list_records = 0;
 }
 
-static const char *single_key;
+void kv_pair_output_end(void)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	static const uint8_t brk = CBOR_BREAK;
+
+	if (!ctx->kv_in_list)
+		return;
+
+	if (ctx->kv_style == KV_STYLE_CBOR)
+		mosys_write(&brk, 1);
+	else if (ctx->kv_list_records)
+		mosys_write("\n]\n", 3);
+	else
+		mosys_write("]\n", 2);
+
+	ctx->kv_schema = NULL;
+	ctx->kv_in_list = 0;
+}
+
+void kv_pair_set_sink(kv_pair_sink sink, void *arg)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	ctx->kv_sink = sink;
+	ctx->kv_sink_arg = arg;
+	ctx->kv_sink_stopped = 0;
+}
+
+int kv_pair_print_stopped(void)
+{
+	return mosys_ctx_get()->kv_sink_stopped;
+}
 
 const char *kv_get_single_key(void)
 {
-	return single_key;
+	return mosys_ctx_get()->kv_single_key;
 }
 
 void kv_set_single_key(const char *key)
 {
-	single_key = key;
+	mosys_ctx_get()->kv_single_key = key;
 }
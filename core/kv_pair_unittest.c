@@ -0,0 +1,259 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// cmocka doesn't include some headers it uses, e.g. setjmp. Prevent
+// clang-format from putting the headers in order, so it gets the above
+// includes.
+// clang-format off
+#include <cmocka.h>
+// clang-format on
+
+#include "mosys/globals.h"
+#include "mosys/kv_pair.h"
+
+static int print_single(struct kv_pair *kv, char *buf, size_t size)
+{
+	FILE *fp = fmemopen(buf, size, "w");
+	int rc;
+
+	assert_non_null(fp);
+	rc = kv_pair_print_to_file(fp, kv, KV_STYLE_SINGLE);
+	fclose(fp);
+
+	return rc;
+}
+
+static struct kv_pair *dimm_record(void)
+{
+	struct kv_pair *kv = kv_pair_new();
+
+	kv_pair_add(kv, "dimm", "0");
+	kv_pair_add(kv, "size", "old");
+	kv_pair_add(kv, "size_mb", "4096");
+	kv_pair_add(kv, "speeds", "DDR4-2400");
+
+	return kv;
+}
+
+static void single_prints_keys_in_given_order(void **state)
+{
+	struct kv_pair *kv = dimm_record();
+	char buf[64] = "";
+
+	kv_set_single_key("speeds,size_mb");
+	assert_int_equal(print_single(kv, buf, sizeof(buf)), 0);
+	assert_string_equal(buf, "DDR4-2400 | 4096\n");
+
+	kv_set_single_key("size_mb");
+	assert_int_equal(print_single(kv, buf, sizeof(buf)), 0);
+	assert_string_equal(buf, "4096\n");
+
+	kv_set_single_key("missing,nope");
+	assert_int_equal(print_single(kv, buf, sizeof(buf)), -1);
+
+	kv_pair_free(kv);
+	kv_set_single_key(NULL);
+}
+
+static void pair_style_escapes_quotes(void **state)
+{
+	struct kv_pair *kv = kv_pair_new();
+	char buf[64] = "";
+	FILE *fp = fmemopen(buf, sizeof(buf), "w");
+
+	assert_non_null(fp);
+	kv_pair_add(kv, "name", "say \"hi\"");
+	kv_pair_add(kv, "quote", "\"");
+	assert_int_equal(kv_pair_print_to_file(fp, kv, KV_STYLE_PAIR), 0);
+	fclose(fp);
+	assert_string_equal(buf, "name=\"say \\\"hi\\\"\" quote=\"\\\"\" \n");
+
+	kv_pair_free(kv);
+}
+
+static void json_style_escapes_and_lists(void **state)
+{
+	struct kv_pair *kv = kv_pair_new();
+	char buf[128] = "";
+	FILE *fp = fmemopen(buf, sizeof(buf), "w");
+	FILE *saved = mosys_get_output_file();
+
+	assert_non_null(fp);
+	kv_pair_add(kv, "a\"b", "x\\y\n\x01");
+	mosys_set_kv_pair_style(KV_STYLE_JSON);
+	mosys_set_output_file(fp);
+
+	kv_pair_output_begin(NULL, 1);
+	kv_pair_output_end();
+	kv_pair_output_begin(NULL, 1);
+	assert_int_equal(kv_pair_print(kv), 0);
+	assert_int_equal(kv_pair_print(kv), 0);
+	kv_pair_output_end();
+	assert_int_equal(kv_pair_print(kv), 0);
+
+	mosys_set_output_file(saved);
+	mosys_set_kv_pair_style(KV_STYLE_VALUE);
+	fclose(fp);
+	assert_string_equal(buf,
+			    "[]\n"
+			    "[\n"
+			    "{\"a\\\"b\":\"x\\\\y\\n\\u0001\"},\n"
+			    "{\"a\\\"b\":\"x\\\\y\\n\\u0001\"}\n"
+			    "]\n"
+			    "{\"a\\\"b\":\"x\\\\y\\n\\u0001\"}\n");
+
+	kv_pair_free(kv);
+}
+
+static void json_style_replaces_invalid_utf8(void **state)
+{
+	struct kv_pair *kv = kv_pair_new();
+	char buf[128] = "";
+	FILE *fp = fmemopen(buf, sizeof(buf), "w");
+	FILE *saved = mosys_get_output_file();
+
+	assert_non_null(fp);
+	/* valid 2 and 4 byte sequences, a stray high byte, then a
+	   truncated, an overlong and a surrogate sequence */
+	kv_pair_add(kv, "part", "\xc3\xa9\xf0\x9f\x98\x80 M\xff"
+		    "\xe2\x82 \xc0\xaf \xed\xa0\x80");
+	mosys_set_kv_pair_style(KV_STYLE_JSON);
+	mosys_set_output_file(fp);
+	assert_int_equal(kv_pair_print(kv), 0);
+	mosys_set_output_file(saved);
+	mosys_set_kv_pair_style(KV_STYLE_VALUE);
+	fclose(fp);
+
+	assert_string_equal(buf,
+			    "{\"part\":\"\xc3\xa9\xf0\x9f\x98\x80 M\\ufffd"
+			    "\\ufffd\\ufffd \\ufffd\\ufffd "
+			    "\\ufffd\\ufffd\\ufffd\"}\n");
+
+	kv_pair_free(kv);
+}
+
+static void cbor_style_uses_schema_and_types(void **state)
+{
+	static const struct kv_schema schema[] = {
+		{ "entry",	KV_TYPE_INT },
+		{ "ecc",	KV_TYPE_BOOL },
+		{ NULL }
+	};
+	static const uint8_t expected[] = {
+		0x82,					/* [schema, records] */
+		0x82,					/* schema */
+		0x82, 0x65, 'e', 'n', 't', 'r', 'y', 0x63, 'i', 'n', 't',
+		0x82, 0x63, 'e', 'c', 'c', 0x64, 'b', 'o', 'o', 'l',
+		0x9f,					/* records */
+		0xa3,					/* record, 3 pairs */
+		0x00, 0x19, 0x01, 0x2c,			/* entry: 300 */
+		0x01, 0xf5,				/* ecc: true */
+		0x61, 't', 0x38, 0x63,			/* "t": -100 */
+		0xff,
+	};
+	struct kv_pair *kv = kv_pair_new();
+	uint8_t buf[64];
+	FILE *fp = fmemopen(buf, sizeof(buf), "w");
+	FILE *saved = mosys_get_output_file();
+
+	assert_non_null(fp);
+	kv_pair_add_int(kv, "entry", 300);
+	kv_pair_add_bool(kv, "ecc", 1);
+	kv_pair_fmt_int(kv, "t", -100, "minus %d", 100);
+	assert_string_equal(kv_pair_get(kv, "t"), "minus 100");
+
+	mosys_set_kv_pair_style(KV_STYLE_CBOR);
+	mosys_set_output_file(fp);
+	kv_pair_output_begin(schema, 0);
+	assert_int_equal(kv_pair_print(kv), 0);
+	kv_pair_output_end();
+	mosys_set_output_file(saved);
+	mosys_set_kv_pair_style(KV_STYLE_VALUE);
+
+	assert_int_equal(ftell(fp), sizeof(expected));
+	fclose(fp);
+	assert_memory_equal(buf, expected, sizeof(expected));
+
+	kv_pair_free(kv);
+}
+
+static void key_wanted_matches_whole_keys(void **state)
+{
+	static const char *const timing_keys[] = { "speeds", NULL };
+	static const char *const id_keys[] = { "module_mfg", "part_number",
+					       NULL };
+
+	/* every key is printed unless -s is used */
+	kv_set_single_key("size_mb,speeds");
+	assert_true(kv_key_wanted("size"));
+
+	mosys_set_kv_pair_style(KV_STYLE_SINGLE);
+	assert_true(kv_key_wanted("size_mb"));
+	assert_true(kv_key_wanted("speeds"));
+	assert_false(kv_key_wanted("size"));
+	assert_false(kv_key_wanted("size_mb,speeds"));
+	assert_true(kv_any_key_wanted(timing_keys));
+	assert_false(kv_any_key_wanted(id_keys));
+
+	mosys_set_kv_pair_style(KV_STYLE_VALUE);
+	kv_set_single_key(NULL);
+}
+
+static void record_grows_past_inline_space(void **state)
+{
+	struct kv_pair *kv = kv_pair_new();
+	struct kv_pair *copy;
+	char key[16], value[16];
+	char long_value[600];
+	int i;
+
+	memset(long_value, 'x', sizeof(long_value) - 1);
+	long_value[sizeof(long_value) - 1] = '\0';
+
+	for (i = 0; i < 40; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		kv_pair_add_flags(kv, key, "v", KV_PAIR_COPY_KEY);
+	}
+	kv_pair_fmt(kv, "formatted", "%s-%d", long_value, 42);
+	kv_pair_add(kv, "skipped", NULL);
+
+	assert_int_equal(kv_pair_count(kv), 41);
+	assert_string_equal(kv_pair_key(kv, 39), "key39");
+	snprintf(value, sizeof(value), "x-%d", 42);
+	assert_int_equal(strlen(kv_pair_get(kv, "formatted")),
+			 strlen(long_value) + 3);
+	assert_string_equal(kv_pair_get(kv, "formatted") + strlen(long_value) - 1,
+			    value);
+	assert_null(kv_pair_get(kv, "skipped"));
+
+	copy = kv_pair_append(kv_pair_new(), kv);
+	kv_pair_free(kv);
+	assert_int_equal(kv_pair_count(copy), 41);
+	assert_string_equal(kv_pair_key(copy, 0), "key0");
+	assert_string_equal(kv_pair_get(copy, "key17"), "v");
+	kv_pair_free(copy);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(single_prints_keys_in_given_order),
+		cmocka_unit_test(pair_style_escapes_quotes),
+		cmocka_unit_test(json_style_escapes_and_lists),
+		cmocka_unit_test(json_style_replaces_invalid_utf8),
+		cmocka_unit_test(cbor_style_uses_schema_and_types),
+		cmocka_unit_test(key_wanted_matches_whole_keys),
+		cmocka_unit_test(record_grows_past_inline_space),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
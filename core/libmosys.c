@@ -0,0 +1,366 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * libmosys.c: structured, non-printing API for embedding mosys
+ *
+ * Commands build key=value records and hand them to kv_pair_print().
+ * Rather than duplicating every command, the library routes those
+ * records to a sink which collects them, so the CLI and the library
+ * share one implementation of each command.
+ *
+ * Each handle has its own context, which is made current for the
+ * duration of every call, so that handles do not share log and output
+ * settings, counters or I2C devices.  The platform interfaces and EC
+ * devices are process-wide, so calls also hold a library-wide lock.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mosys/alloc.h"
+#include "mosys/cli.h"
+#include "mosys/context.h"
+#include "mosys/globals.h"
+#include "mosys/kv_pair.h"
+#include "mosys/libmosys.h"
+#include "mosys/log.h"
+#include "mosys/platform.h"
+
+#include "lib/math.h"
+#include "lib/sku.h"
+
+struct mosys_handle {
+	struct platform_intf *intf;
+	struct mosys_ctx *ctx;
+	FILE *null_out;		/* swallows anything commands still print */
+};
+
+static pthread_mutex_t libmosys_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* serialize a call on a handle and make its context current */
+static struct mosys_ctx *handle_enter(struct mosys_handle *h)
+{
+	pthread_mutex_lock(&libmosys_lock);
+	return mosys_ctx_set(h->ctx);
+}
+
+static void handle_leave(struct mosys_ctx *prev)
+{
+	mosys_ctx_set(prev);
+	pthread_mutex_unlock(&libmosys_lock);
+}
+
+struct mosys_handle *mosys_open(const char *platform_name)
+{
+	struct mosys_handle *h;
+	struct mosys_ctx *prev;
+	FILE *null_out;
+
+	null_out = fopen("/dev/null", "w");
+	if (!null_out)
+		return NULL;
+
+	h = mosys_zalloc(sizeof(*h));
+	h->null_out = null_out;
+	h->ctx = mosys_ctx_new();
+	prev = handle_enter(h);
+
+	/* fails harmlessly if the caller already set up logging */
+	mosys_log_init("libmosys", LOG_ERR, NULL);
+	mosys_set_output_file(null_out);
+	/* callers get every field, whatever -s the process was given */
+	kv_set_single_key(NULL);
+
+	h->intf = mosys_platform_setup(platform_name);
+	handle_leave(prev);
+
+	if (!h->intf) {
+		mosys_ctx_free(h->ctx);
+		fclose(null_out);
+		free(h);
+		errno = ENODEV;
+		return NULL;
+	}
+
+	return h;
+}
+
+void mosys_close(struct mosys_handle *h)
+{
+	struct mosys_ctx *prev;
+
+	if (!h)
+		return;
+
+	prev = handle_enter(h);
+	mosys_platform_destroy(h->intf);
+	handle_leave(prev);
+
+	mosys_ctx_free(h->ctx);
+	fclose(h->null_out);
+	free(h);
+}
+
+/*
+ * run_with_sink  -  run a command, handing its records to a sink
+ *
+ * @h:		handle from mosys_open()
+ * @argc:	number of command words
+ * @argv:	command words
+ * @sink:	callback to receive each record
+ * @arg:	argument to pass to @sink
+ *
+ * returns 0 to indicate success
+ * returns -1 and sets errno to indicate failure
+ */
+static int run_with_sink(struct mosys_handle *h, int argc, char **argv,
+			 kv_pair_sink sink, void *arg)
+{
+	struct mosys_ctx *prev;
+	int status;
+
+	if (!h || argc < 1) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	prev = handle_enter(h);
+	kv_pair_set_sink(sink, arg);
+	status = mosys_run_cmd(h->intf, argc, argv);
+	kv_pair_set_sink(NULL, NULL);
+	handle_leave(prev);
+
+	if (status) {
+		errno = status > 0 ? status : EIO;
+		return -1;
+	}
+
+	return 0;
+}
+
+static int collect_record(struct kv_pair *kv_list, void *arg)
+{
+	struct mosys_records *res = arg;
+
+	res->records = mosys_realloc(res->records,
+				     (res->count + 1) * sizeof(*res->records));
+	res->records[res->count++] = kv_pair_append(kv_pair_new(), kv_list);
+	return 0;
+}
+
+int mosys_query(struct mosys_handle *h, int argc, char **argv,
+		struct mosys_records *res)
+{
+	res->records = NULL;
+	res->count = 0;
+
+	if (run_with_sink(h, argc, argv, collect_record, res) < 0) {
+		int errsv = errno;
+
+		mosys_records_free(res);
+		errno = errsv;
+		return -1;
+	}
+
+	return 0;
+}
+
+void mosys_records_free(struct mosys_records *res)
+{
+	int i;
+
+	for (i = 0; i < res->count; i++)
+		kv_pair_free(res->records[i]);
+	free(res->records);
+	res->records = NULL;
+	res->count = 0;
+}
+
+const char *mosys_record_get(const struct kv_pair *record, const char *key)
+{
+	return kv_pair_get(record, key);
+}
+
+int mosys_get_platform_info(struct mosys_handle *h,
+			    struct mosys_platform_info *info)
+{
+	struct platform_intf *intf;
+	struct mosys_ctx *prev;
+
+	if (!h) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	intf = h->intf;
+	memset(info, 0, sizeof(*info));
+	prev = handle_enter(h);
+	info->name = intf->name;
+
+	if (intf->cb && intf->cb->sys && intf->cb->sys->vendor)
+		info->vendor = intf->cb->sys->vendor(intf);
+	if (intf->cb && intf->cb->sys && intf->cb->sys->version)
+		info->version = intf->cb->sys->version(intf);
+	info->model = sku_get_model(intf);
+	info->chassis = sku_get_chassis(intf);
+	info->brand = sku_get_brand(intf);
+	info->customization = sku_get_customization(intf);
+	info->sku_number = sku_get_number(intf);
+	handle_leave(prev);
+
+	return 0;
+}
+
+void mosys_platform_info_free(struct mosys_platform_info *info)
+{
+	free(info->vendor);
+	free(info->version);
+	free(info->model);
+	free(info->chassis);
+	free(info->brand);
+	free(info->customization);
+	memset(info, 0, sizeof(*info));
+	info->sku_number = -1;
+}
+
+int mosys_get_dimm_count(struct mosys_handle *h)
+{
+	struct platform_intf *intf;
+	struct mosys_ctx *prev;
+	int count;
+
+	if (!h) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	intf = h->intf;
+	if (!intf->cb || !intf->cb->memory || !intf->cb->memory->dimm_count) {
+		errno = ENOSYS;
+		return -1;
+	}
+
+	prev = handle_enter(h);
+	count = intf->cb->memory->dimm_count(intf);
+	handle_leave(prev);
+
+	return count;
+}
+
+/* merge the records of "memory spd print all" into one list */
+static int merge_dimm_record(struct kv_pair *kv_list, void *arg)
+{
+	struct kv_pair **fields = arg;
+	const char *key;
+	int i;
+
+	if (!*fields)
+		*fields = kv_pair_new();
+
+	for (i = 0; i < kv_pair_count(kv_list); i++) {
+		key = kv_pair_key(kv_list, i);
+		/* every record starts with the DIMM number */
+		if (!strcmp(key, "dimm") && kv_pair_get(*fields, "dimm"))
+			continue;
+		kv_pair_add(*fields, key, kv_pair_value(kv_list, i));
+	}
+
+	return 0;
+}
+
+int mosys_get_dimm_info(struct mosys_handle *h, int dimm,
+			struct kv_pair **fields)
+{
+	char dimm_str[16];
+	char *argv[] = { "memory", "spd", "print", "all", dimm_str };
+
+	*fields = NULL;
+	snprintf(dimm_str, sizeof(dimm_str), "%d", dimm);
+
+	if (run_with_sink(h, ARRAY_SIZE(argv), argv, merge_dimm_record,
+			  fields) < 0) {
+		int errsv = errno;
+
+		kv_pair_free(*fields);
+		*fields = NULL;
+		errno = errsv;
+		return -1;
+	}
+
+	if (!*fields) {
+		errno = ENODEV;
+		return -1;
+	}
+
+	return 0;
+}
+
+static int copy_ec_info(struct kv_pair *kv_list, void *arg)
+{
+	struct mosys_ec_info *info = arg;
+	const char *value;
+
+	value = mosys_record_get(kv_list, "vendor");
+	if (value)
+		snprintf(info->vendor, sizeof(info->vendor), "%s", value);
+	value = mosys_record_get(kv_list, "name");
+	if (value)
+		snprintf(info->name, sizeof(info->name), "%s", value);
+	value = mosys_record_get(kv_list, "fw_version");
+	if (value)
+		snprintf(info->fw_version, sizeof(info->fw_version), "%s",
+			 value);
+
+	return 0;
+}
+
+int mosys_get_ec_info(struct mosys_handle *h, enum mosys_ec_type type,
+		      struct mosys_ec_info *info)
+{
+	static const char *ec_cmds[] = {
+		[MOSYS_EC_MAIN]	= "ec",
+		[MOSYS_EC_PD]	= "pd",
+		[MOSYS_EC_FP]	= "fp",
+	};
+	char *argv[2];
+
+	if (type >= ARRAY_SIZE(ec_cmds)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	memset(info, 0, sizeof(*info));
+	argv[0] = (char *)ec_cmds[type];
+	argv[1] = "info";
+	return run_with_sink(h, ARRAY_SIZE(argv), argv, copy_ec_info, info);
+}
+
+struct eventlog_iter {
+	mosys_eventlog_fn fn;
+	void *arg;
+};
+
+/* stopping makes "eventlog list" skip decoding the remaining entries */
+static int pass_eventlog_entry(struct kv_pair *kv_list, void *arg)
+{
+	struct eventlog_iter *iter = arg;
+
+	return iter->fn(kv_list, iter->arg) ? KV_SINK_STOP : 0;
+}
+
+int mosys_eventlog_foreach(struct mosys_handle *h, mosys_eventlog_fn fn,
+			   void *arg)
+{
+	struct eventlog_iter iter = {
+		.fn = fn,
+		.arg = arg,
+	};
+	char *argv[] = { "eventlog", "list" };
+
+	return run_with_sink(h, ARRAY_SIZE(argv), argv, pass_eventlog_entry,
+			     &iter);
+}
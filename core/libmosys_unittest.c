@@ -0,0 +1,251 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// cmocka doesn't include some headers it uses, e.g. setjmp. Prevent
+// clang-format from putting the headers in order, so it gets the above
+// includes.
+// clang-format off
+#include <cmocka.h>
+// clang-format on
+
+#include "mosys/kv_pair.h"
+#include "mosys/libmosys.h"
+#include "mosys/platform.h"
+
+static int print_record(const char *key1, const char *value1,
+			const char *key2, const char *value2)
+{
+	struct kv_pair *kv = kv_pair_new();
+	int rc;
+
+	kv_pair_add(kv, key1, value1);
+	kv_pair_add(kv, key2, value2);
+	rc = kv_pair_print(kv);
+	kv_pair_free(kv);
+
+	return rc;
+}
+
+static int fake_records_cmd(struct platform_intf *intf,
+			    struct platform_cmd *cmd, int argc, char **argv)
+{
+	print_record("name", "first", "value", "1");
+	return print_record("name", "second", "value", "2");
+}
+
+static int fake_fail_cmd(struct platform_intf *intf,
+			 struct platform_cmd *cmd, int argc, char **argv)
+{
+	errno = EIO;
+	return -1;
+}
+
+static int fake_spd_all_cmd(struct platform_intf *intf,
+			    struct platform_cmd *cmd, int argc, char **argv)
+{
+	if (argc != 1 || strcmp(argv[0], "0"))
+		return 0;	/* only DIMM 0 is present */
+
+	print_record("dimm", "0", "dram", "LPDDR4");
+	return print_record("dimm", "0", "size_mb", "4096");
+}
+
+static int fake_eventlog_decoded;
+
+static int fake_eventlog_list_cmd(struct platform_intf *intf,
+				  struct platform_cmd *cmd, int argc,
+				  char **argv)
+{
+	static const char *entries[] = { "0", "1", "2" };
+	int i, rc = 0;
+
+	fake_eventlog_decoded = 0;
+	for (i = 0; i < 3 && !kv_pair_print_stopped(); i++) {
+		fake_eventlog_decoded++;
+		rc |= print_record("entry", entries[i], "type", "System boot");
+	}
+
+	return rc;
+}
+
+static struct platform_cmd fake_test_cmds[] = {
+	{
+		.name	= "records",
+		.type	= ARG_TYPE_GETTER,
+		.arg	= { .func = fake_records_cmd }
+	},
+	{
+		.name	= "fail",
+		.type	= ARG_TYPE_GETTER,
+		.arg	= { .func = fake_fail_cmd }
+	},
+	{ NULL }
+};
+
+static struct platform_cmd fake_spd_print_cmds[] = {
+	{
+		.name	= "all",
+		.type	= ARG_TYPE_GETTER,
+		.arg	= { .func = fake_spd_all_cmd }
+	},
+	{ NULL }
+};
+
+static struct platform_cmd fake_spd_cmds[] = {
+	{
+		.name	= "print",
+		.type	= ARG_TYPE_SUB,
+		.arg	= { .sub = fake_spd_print_cmds }
+	},
+	{ NULL }
+};
+
+static struct platform_cmd fake_memory_cmds[] = {
+	{
+		.name	= "spd",
+		.type	= ARG_TYPE_SUB,
+		.arg	= { .sub = fake_spd_cmds }
+	},
+	{ NULL }
+};
+
+static struct platform_cmd fake_eventlog_cmds[] = {
+	{
+		.name	= "list",
+		.type	= ARG_TYPE_GETTER,
+		.arg	= { .func = fake_eventlog_list_cmd }
+	},
+	{ NULL }
+};
+
+static struct platform_cmd fake_test = {
+	.name	= "test",
+	.type	= ARG_TYPE_SUB,
+	.arg	= { .sub = fake_test_cmds }
+};
+
+static struct platform_cmd fake_memory = {
+	.name	= "memory",
+	.type	= ARG_TYPE_SUB,
+	.arg	= { .sub = fake_memory_cmds }
+};
+
+static struct platform_cmd fake_eventlog = {
+	.name	= "eventlog",
+	.type	= ARG_TYPE_SUB,
+	.arg	= { .sub = fake_eventlog_cmds }
+};
+
+static struct platform_cmd *fake_sub[] = {
+	&fake_test,
+	&fake_memory,
+	&fake_eventlog,
+	NULL
+};
+
+static struct platform_intf fake_intf = {
+	.type = PLATFORM_X86_64,
+	.sub = fake_sub,
+};
+REGISTER_PLATFORM(fake_intf, "fake");
+
+static void query_collects_records(void **state)
+{
+	struct mosys_handle *h = mosys_open("fake");
+	struct mosys_records res;
+	char *argv[] = { "test", "records" };
+
+	assert_non_null(h);
+	assert_int_equal(mosys_query(h, 2, argv, &res), 0);
+	assert_int_equal(res.count, 2);
+	assert_string_equal(mosys_record_get(res.records[0], "name"), "first");
+	assert_string_equal(mosys_record_get(res.records[1], "value"), "2");
+	assert_null(mosys_record_get(res.records[1], "missing"));
+
+	mosys_records_free(&res);
+	assert_int_equal(res.count, 0);
+	mosys_close(h);
+}
+
+static void query_failure_sets_errno(void **state)
+{
+	struct mosys_handle *h = mosys_open("fake");
+	struct mosys_records res;
+	char *fail[] = { "test", "fail" };
+	char *missing[] = { "test", "missing" };
+
+	assert_non_null(h);
+	assert_int_equal(mosys_query(h, 2, fail, &res), -1);
+	assert_int_equal(errno, EIO);
+	assert_int_equal(res.count, 0);
+	assert_int_equal(mosys_query(h, 2, missing, &res), -1);
+	assert_int_equal(errno, EINVAL);
+
+	mosys_close(h);
+}
+
+static void dimm_info_merges_records(void **state)
+{
+	struct mosys_handle *h = mosys_open("fake");
+	struct kv_pair *fields;
+	int i, dimm_keys = 0;
+
+	assert_non_null(h);
+	assert_int_equal(mosys_get_dimm_info(h, 0, &fields), 0);
+	assert_string_equal(mosys_record_get(fields, "dram"), "LPDDR4");
+	assert_string_equal(mosys_record_get(fields, "size_mb"), "4096");
+	for (i = 0; i < kv_pair_count(fields); i++) {
+		if (!strcmp(kv_pair_key(fields, i), "dimm"))
+			dimm_keys++;
+	}
+	assert_int_equal(dimm_keys, 1);
+	kv_pair_free(fields);
+
+	assert_int_equal(mosys_get_dimm_info(h, 1, &fields), -1);
+	assert_int_equal(errno, ENODEV);
+	assert_null(fields);
+
+	mosys_close(h);
+}
+
+static int count_entries(const struct kv_pair *entry, void *arg)
+{
+	int *count = arg;
+
+	return ++*count == 2;
+}
+
+static void eventlog_foreach_stops(void **state)
+{
+	struct mosys_handle *h = mosys_open("fake");
+	int count = 0;
+
+	assert_non_null(h);
+	assert_int_equal(mosys_eventlog_foreach(h, count_entries, &count), 0);
+	assert_int_equal(count, 2);
+	/* the entry after the one which stopped is never decoded */
+	assert_int_equal(fake_eventlog_decoded, 2);
+
+	mosys_close(h);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(query_collects_records),
+		cmocka_unit_test(query_failure_sets_errno),
+		cmocka_unit_test(dimm_info_merges_records),
+		cmocka_unit_test(eventlog_foreach_stops),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -34,19 +34,375 @@
 #include <stdio.h>
 #include <errno.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
+#include "mosys/alloc.h"
+#include "mosys/context.h"
 #include "mosys/log.h"
 
 #define LOG_MSG_LENGTH	1024
 
-struct logpriv {
-	const char *name;
-	enum log_levels threshold;
-	FILE *outfile;
-	int valid;
+/*
+ * Messages which are printed are collected in a buffer and written out
+ * together: right away for warnings and worse, otherwise when the buffer
+ * fills up, after each command and when logging stops.  Everything is
+ * written right away when someone is likely watching, i.e. when the log
+ * goes to a terminal or info messages are asked for, so that nothing is
+ * held back if the command then hangs or crashes.
+ */
+#define LOG_BUF_SIZE		(4 * LOG_MSG_LENGTH)
+#define LOG_FLUSH_LEVEL		LOG_WARNING
+#define LOG_DIRECT_LEVEL	LOG_INFO
+
+/*
+ * Messages below the threshold, down to LOG_RECORD_LEVEL, are kept in a
+ * ring of the last LOG_RING_ENTRIES so they can be shown when a command
+ * fails.  Only the format and the raw arguments are stored, a message is
+ * formatted only if it is shown.  Strings are copied, as they are likely
+ * gone by then.  Messages with a format the recorder does not handle
+ * (e.g. a '*' width) are formatted right away instead.
+ */
+#define LOG_RECORD_LEVEL	LOG_DEBUG
+#define LOG_RING_ENTRIES	128
+#define LOG_RING_ARGS		8
+#define LOG_RING_TEXT		192
+
+enum log_arg_type {
+	LOG_ARG_NONE,		/* %% */
+	LOG_ARG_INT,
+	LOG_ARG_LONG,
+	LOG_ARG_LLONG,
+	LOG_ARG_SIZE,
+	LOG_ARG_INTMAX,
+	LOG_ARG_DOUBLE,
+	LOG_ARG_PTR,
+	LOG_ARG_STR,
+	LOG_ARG_UNKNOWN,
 };
-static struct logpriv logpriv;
+
+union log_arg {
+	long long ll;
+	intmax_t j;
+	double d;
+	const void *p;
+	size_t str_off;
+};
+
+struct log_entry {
+	const char *format;	/* NULL if text is the formatted message */
+	enum log_levels level;
+	int errsv;		/* errno for lperror(), -1 otherwise */
+	union log_arg args[LOG_RING_ARGS];
+	char text[LOG_RING_TEXT];	/* copies of string arguments */
+};
+
+struct log_ring {
+	struct log_entry entries[LOG_RING_ENTRIES];
+	unsigned int head;	/* next entry to use */
+	unsigned int count;
+};
+
+/*
+ * log_next_spec  -  find the next conversion in a printf format
+ *
+ * @format:	format to scan
+ * @start:	set to the start of the conversion
+ * @type:	set to the type of its argument
+ *
+ * returns a pointer past the conversion
+ * returns NULL if there are no more conversions
+ */
+static const char *log_next_spec(const char *format, const char **start,
+				 enum log_arg_type *type)
+{
+	int longs = 0, size = 0, intmax = 0;
+	const char *p = strchr(format, '%');
+
+	if (!p)
+		return NULL;
+
+	*start = p++;
+	p += strspn(p, "-+ #0'");
+	p += strspn(p, "0123456789");
+	if (*p == '.') {
+		p++;
+		p += strspn(p, "0123456789");
+	}
+
+	for (;; p++) {
+		if (*p == 'h')
+			continue;
+		else if (*p == 'l')
+			longs++;
+		else if (*p == 'z' || *p == 't')
+			size = 1;
+		else if (*p == 'j')
+			intmax = 1;
+		else
+			break;
+	}
+
+	switch (*p) {
+	case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+		if (intmax)
+			*type = LOG_ARG_INTMAX;
+		else if (size)
+			*type = LOG_ARG_SIZE;
+		else if (longs > 1)
+			*type = LOG_ARG_LLONG;
+		else if (longs)
+			*type = LOG_ARG_LONG;
+		else
+			*type = LOG_ARG_INT;
+		break;
+	case 'e': case 'E': case 'f': case 'F': case 'g': case 'G':
+	case 'a': case 'A':
+		*type = LOG_ARG_DOUBLE;
+		break;
+	case 'p':
+		*type = LOG_ARG_PTR;
+		break;
+	case 's':
+		*type = longs ? LOG_ARG_UNKNOWN : LOG_ARG_STR;
+		break;
+	case '%':
+		*type = LOG_ARG_NONE;
+		break;
+	default:
+		/* '*', %n, long double, ... */
+		*type = LOG_ARG_UNKNOWN;
+		return *p ? p + 1 : p;
+	}
+
+	return p + 1;
+}
+
+/* store the arguments of a message, returns -1 if it cannot be deferred */
+static int log_store_args(struct log_entry *entry, const char *format,
+			  va_list vptr)
+{
+	enum log_arg_type type;
+	const char *start, *str;
+	size_t text_len = 0, len;
+	int n = 0;
+
+	while ((format = log_next_spec(format, &start, &type))) {
+		union log_arg *arg = &entry->args[n];
+
+		if (type == LOG_ARG_NONE)
+			continue;
+		if (type == LOG_ARG_UNKNOWN || n == LOG_RING_ARGS)
+			return -1;
+
+		switch (type) {
+		case LOG_ARG_INT:
+			arg->ll = va_arg(vptr, int);
+			break;
+		case LOG_ARG_LONG:
+			arg->ll = va_arg(vptr, long);
+			break;
+		case LOG_ARG_LLONG:
+			arg->ll = va_arg(vptr, long long);
+			break;
+		case LOG_ARG_SIZE:
+			arg->ll = va_arg(vptr, size_t);
+			break;
+		case LOG_ARG_INTMAX:
+			arg->j = va_arg(vptr, intmax_t);
+			break;
+		case LOG_ARG_DOUBLE:
+			arg->d = va_arg(vptr, double);
+			break;
+		case LOG_ARG_PTR:
+			arg->p = va_arg(vptr, void *);
+			break;
+		case LOG_ARG_STR:
+			str = va_arg(vptr, const char *);
+			if (!str)
+				str = "(null)";
+			/* truncate rather than give up on the message */
+			len = strlen(str);
+			if (len > sizeof(entry->text) - text_len - 1)
+				len = sizeof(entry->text) - text_len - 1;
+			memcpy(entry->text + text_len, str, len);
+			entry->text[text_len + len] = '\0';
+			arg->str_off = text_len;
+			text_len += len + 1;
+			if (text_len == sizeof(entry->text))
+				text_len--;	/* further strings are empty */
+			break;
+		default:
+			break;
+		}
+		n++;
+	}
+
+	return 0;
+}
+
+/* format a recorded message */
+static void log_format_entry(const struct log_entry *entry, char *buf,
+			     size_t size)
+{
+	const char *format = entry->format, *start;
+	const union log_arg *arg = entry->args;
+	enum log_arg_type type;
+	char spec[32];
+	size_t len = 0;
+	int ret = 0;
+
+	buf[0] = '\0';
+	if (!format)
+		snprintf(buf, size, "%s", entry->text);
+
+	while (format && len < size) {
+		const char *end = log_next_spec(format, &start, &type);
+
+		/* text up to the conversion, or the end */
+		if (!end)
+			start = format + strlen(format);
+		ret = snprintf(buf + len, size - len, "%.*s",
+			       (int)(start - format), format);
+		len += ret;
+		if (!end || len >= size)
+			break;
+
+		snprintf(spec, sizeof(spec), "%.*s", (int)(end - start), start);
+		switch (type) {
+		case LOG_ARG_NONE:
+			ret = snprintf(buf + len, size - len, "%%");
+			break;
+		case LOG_ARG_INT:
+			ret = snprintf(buf + len, size - len, spec, (int)arg->ll);
+			break;
+		case LOG_ARG_LONG:
+			ret = snprintf(buf + len, size - len, spec, (long)arg->ll);
+			break;
+		case LOG_ARG_LLONG:
+			ret = snprintf(buf + len, size - len, spec, arg->ll);
+			break;
+		case LOG_ARG_SIZE:
+			ret = snprintf(buf + len, size - len, spec,
+				       (size_t)arg->ll);
+			break;
+		case LOG_ARG_INTMAX:
+			ret = snprintf(buf + len, size - len, spec, arg->j);
+			break;
+		case LOG_ARG_DOUBLE:
+			ret = snprintf(buf + len, size - len, spec, arg->d);
+			break;
+		case LOG_ARG_PTR:
+			ret = snprintf(buf + len, size - len, spec, arg->p);
+			break;
+		case LOG_ARG_STR:
+			ret = snprintf(buf + len, size - len, spec,
+				       entry->text + arg->str_off);
+			break;
+		case LOG_ARG_UNKNOWN:
+			ret = 0;
+			break;
+		}
+		if (type != LOG_ARG_NONE)
+			arg++;
+		if (ret > 0)
+			len += ret;
+		format = end;
+	}
+
+	if (entry->errsv >= 0) {
+		len = strlen(buf);
+		snprintf(buf + len, size - len, ": %s\n",
+			 strerror(entry->errsv));
+	}
+}
+
+/* keep a message which is not printed */
+static void log_record(struct mosys_ctx *ctx, enum log_levels level,
+		       int errsv, const char *format, va_list vptr)
+{
+	struct log_ring *ring = ctx->log_ring;
+	struct log_entry *entry;
+	va_list aq;
+
+	if (!ring)
+		ring = ctx->log_ring = mosys_zalloc(sizeof(*ring));
+
+	entry = &ring->entries[ring->head];
+	ring->head = (ring->head + 1) % LOG_RING_ENTRIES;
+	if (ring->count < LOG_RING_ENTRIES)
+		ring->count++;
+
+	entry->format = format;
+	entry->level = level;
+	entry->errsv = errsv;
+
+	va_copy(aq, vptr);
+	if (log_store_args(entry, format, aq) < 0) {
+		entry->format = NULL;
+		vsnprintf(entry->text, sizeof(entry->text), format, vptr);
+	}
+	va_end(aq);
+}
+
+void log_flush(void)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	if (!ctx->log_len)
+		return;
+
+	fwrite(ctx->log_buf, 1, ctx->log_len, ctx->log_outfile);
+	fflush(ctx->log_outfile);
+	ctx->log_len = 0;
+}
+
+/* print a message, errsv is errno for lperror(), -1 otherwise */
+static void log_emit(struct mosys_ctx *ctx, enum log_levels level,
+		     int errsv, const char *format, va_list vptr)
+{
+	char *msg;
+	int len;
+
+	if (!ctx->log_buf)
+		ctx->log_buf = mosys_malloc(LOG_BUF_SIZE);
+	if (LOG_BUF_SIZE - ctx->log_len < LOG_MSG_LENGTH + 128)
+		log_flush();
+
+	msg = ctx->log_buf + ctx->log_len;
+	len = vsnprintf(msg, LOG_MSG_LENGTH, format, vptr);
+	if (len >= LOG_MSG_LENGTH) {
+		/* keep the end of line, or the next message is glued on */
+		len = LOG_MSG_LENGTH - 1;
+		if (errsv < 0)
+			msg[len - 1] = '\n';
+	}
+	if (len < 0)
+		len = 0;
+
+	if (errsv >= 0) {
+		snprintf(msg + len, 128, ": %s\n", strerror(errsv));
+		len += strlen(msg + len);
+	}
+
+	ctx->log_len += len;
+	if (level <= ctx->log_flush_level)
+		log_flush();
+}
+
+/* decide which messages are written out without batching */
+static void log_update_flush_level(struct mosys_ctx *ctx)
+{
+	int fd = ctx->log_outfile ? fileno(ctx->log_outfile) : -1;
+
+	if (ctx->log_threshold >= LOG_DIRECT_LEVEL || (fd >= 0 && isatty(fd)))
+		ctx->log_flush_level = LOG_SPEW;
+	else
+		ctx->log_flush_level = LOG_FLUSH_LEVEL;
+}
 
 /*
  * return -1 on fail
@@ -55,23 +411,23 @@ static struct logpriv logpriv;
  */
 int lprintf(enum log_levels level, const char *format, ...)
 {
-	char logmsg[LOG_MSG_LENGTH];
+	struct mosys_ctx *ctx = mosys_ctx_get();
 	va_list vptr;
 
-	if (!logpriv.valid) {
+	if (!ctx->log_valid) {
 		return -1;
 	}
 
-	if (logpriv.threshold < level) {
+	va_start(vptr, format);
+	if (ctx->log_threshold < level) {
+		if (level <= LOG_RECORD_LEVEL)
+			log_record(ctx, level, -1, format, vptr);
+		va_end(vptr);
 		return 1;
 	}
-	va_start(vptr, format);
-	vsnprintf(logmsg, LOG_MSG_LENGTH, format, vptr);
+	log_emit(ctx, level, -1, format, vptr);
 	va_end(vptr);
 
-	fprintf(logpriv.outfile, "%s", logmsg);
-	fflush(logpriv.outfile);
-
 	return 0;
 }
 
@@ -82,31 +438,68 @@ int lprintf(enum log_levels level, const char *format, ...)
  */
 int lperror(enum log_levels level, const char *format, ...)
 {
-	char logmsg[LOG_MSG_LENGTH];
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	int errsv = errno;
 	va_list vptr;
 
-	if (!logpriv.valid) {
+	if (!ctx->log_valid) {
 		return -1;
 	}
 
-	if (logpriv.threshold < level) {
+	va_start(vptr, format);
+	if (ctx->log_threshold < level) {
+		if (level <= LOG_RECORD_LEVEL)
+			log_record(ctx, level, errsv, format, vptr);
+		va_end(vptr);
 		return 1;
 	}
-
-	va_start(vptr, format);
-	vsnprintf(logmsg, LOG_MSG_LENGTH, format, vptr);
+	log_emit(ctx, level, errsv, format, vptr);
 	va_end(vptr);
 
-	fprintf(logpriv.outfile, "%s: %s\n", logmsg, strerror(errno));
-	fflush(logpriv.outfile);
-
 	return 0;
 }
 
+void log_recorder_reset(void)
+{
+	struct log_ring *ring = mosys_ctx_get()->log_ring;
+
+	if (ring)
+		ring->count = 0;
+}
+
+void log_recorder_dump(void)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	struct log_ring *ring = ctx->log_ring;
+	char msg[LOG_MSG_LENGTH];
+	unsigned int i, n;
+	size_t len;
+
+	if (!ctx->log_valid || !ring || !ring->count)
+		return;
+
+	log_flush();
+	fprintf(ctx->log_outfile, "--- last %u debug messages:\n", ring->count);
+	for (i = 0; i < ring->count; i++) {
+		n = (ring->head + LOG_RING_ENTRIES - ring->count + i) %
+		    LOG_RING_ENTRIES;
+		log_format_entry(&ring->entries[n], msg, sizeof(msg));
+		len = strlen(msg);
+		fprintf(ctx->log_outfile, "%s%s", msg,
+			len && msg[len - 1] == '\n' ? "" : "\n");
+	}
+	fprintf(ctx->log_outfile, "--- end of debug messages\n");
+	fflush(ctx->log_outfile);
+
+	ring->count = 0;
+}
+
 int mosys_log_init(const char *name, enum log_levels threshold,
                   FILE *output_file)
 {
-	if (logpriv.valid) {
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	if (ctx->log_valid) {
 		return -1;
 	}
 
@@ -114,18 +507,22 @@ int mosys_log_init(const char *name, enum log_levels threshold,
 		output_file = stderr;
 	}
 
-	logpriv.name = name;
-	logpriv.threshold = threshold;
-	logpriv.outfile = output_file;
-	logpriv.valid = 1;
+	ctx->log_name = name;
+	ctx->log_threshold = threshold;
+	ctx->log_outfile = output_file;
+	ctx->log_valid = 1;
+	log_update_flush_level(ctx);
 
 	return 0;
 }
 
 int mosys_log_halt(void)
 {
-	if (logpriv.valid) {
-		logpriv.valid = 0;
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	if (ctx->log_valid) {
+		log_flush();
+		ctx->log_valid = 0;
 		return 0;
 	}
 	return -1;
@@ -133,23 +530,45 @@ int mosys_log_halt(void)
 
 int log_threshold_get(void)
 {
-	if (!logpriv.valid) {
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	if (!ctx->log_valid) {
 		return -1;
 	}
-	return logpriv.threshold;
+	return ctx->log_threshold;
 }
 
 int log_threshold_set(enum log_levels threshold)
 {
-	if (!logpriv.valid) {
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	if (!ctx->log_valid) {
 		return -1;
 	}
 
-	logpriv.threshold = threshold;
+	ctx->log_threshold = threshold;
+	log_update_flush_level(ctx);
 	return 0;
 }
 
+FILE *log_outfile_get(void)
+{
+	return mosys_ctx_get()->log_outfile;
+}
+
+void log_outfile_set(FILE *output_file)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	/* buffered messages belong to the old file */
+	log_flush();
+	ctx->log_outfile = output_file ? output_file : stderr;
+	log_update_flush_level(ctx);
+}
+
 int log_level_enabled(enum log_levels level)
 {
-	return (logpriv.valid && level >= logpriv.threshold);
+	struct mosys_ctx *ctx = mosys_ctx_get();
+
+	return (ctx->log_valid && level <= ctx->log_threshold);
 }
@@ -0,0 +1,155 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// cmocka doesn't include some headers it uses, e.g. setjmp. Prevent
+// clang-format from putting the headers in order, so it gets the above
+// includes.
+// clang-format off
+#include <cmocka.h>
+// clang-format on
+
+#include "mosys/log.h"
+
+static char log_text[4096];
+static FILE *log_fp;
+
+static int log_setup(void **state)
+{
+	memset(log_text, 0, sizeof(log_text));
+	log_fp = fmemopen(log_text, sizeof(log_text), "w");
+	assert_non_null(log_fp);
+	assert_int_equal(mosys_log_init("test", LOG_ERR, log_fp), 0);
+	return 0;
+}
+
+static int log_teardown(void **state)
+{
+	mosys_log_halt();
+	fclose(log_fp);
+	return 0;
+}
+
+static void level_enabled_follows_threshold(void **state)
+{
+	assert_true(log_level_enabled(LOG_ERR));
+	assert_true(log_level_enabled(LOG_CRIT));
+	assert_false(log_level_enabled(LOG_DEBUG));
+
+	log_threshold_set(LOG_DEBUG);
+	assert_true(log_level_enabled(LOG_DEBUG));
+	assert_false(log_level_enabled(LOG_SPEW));
+	log_threshold_set(LOG_ERR);
+}
+
+static void printed_messages_are_buffered(void **state)
+{
+	assert_int_equal(lprintf(LOG_ERR, "error %d\n", 1), 0);
+	assert_int_equal(lprintf(LOG_INFO, "not shown\n"), 1);
+
+	log_threshold_set(LOG_NOTICE);
+	assert_int_equal(lprintf(LOG_NOTICE, "notice %s\n", "message"), 0);
+	fflush(log_fp);
+	assert_string_equal(log_text, "error 1\n");
+
+	log_flush();
+	assert_string_equal(log_text, "error 1\nnotice message\n");
+
+	/* with info messages asked for, nothing is held back */
+	log_threshold_set(LOG_INFO);
+	assert_int_equal(lprintf(LOG_INFO, "info\n"), 0);
+	fflush(log_fp);
+	assert_string_equal(log_text, "error 1\nnotice message\ninfo\n");
+	log_threshold_set(LOG_ERR);
+}
+
+static void long_messages_keep_end_of_line(void **state)
+{
+	char long_msg[2048];
+
+	memset(long_msg, 'x', sizeof(long_msg) - 1);
+	long_msg[sizeof(long_msg) - 1] = '\0';
+
+	assert_int_equal(lprintf(LOG_ERR, "%s\n", long_msg), 0);
+	assert_int_equal(lprintf(LOG_ERR, "next\n"), 0);
+	fflush(log_fp);
+	assert_int_equal(strlen(log_text), 1023 + 5);
+	assert_int_equal(log_text[1022], '\n');
+	assert_string_equal(log_text + 1023, "next\n");
+}
+
+static void recorder_formats_on_dump(void **state)
+{
+	char name[16];
+
+	log_recorder_reset();
+	strcpy(name, "dimm0");
+	lprintf(LOG_DEBUG, "%s: size %jx, %d ranks, %.1f%%\n", name,
+		(uintmax_t)0x1000, 2, 12.5);
+	/* the recorder keeps its own copy of strings */
+	strcpy(name, "gone");
+	errno = ENOENT;
+	lperror(LOG_DEBUG, "Unable to open %s", "/dev/mem");
+	lprintf(LOG_SPEW, "too verbose to keep\n");
+	fflush(log_fp);
+	assert_string_equal(log_text, "");
+
+	log_recorder_dump();
+	assert_string_equal(log_text,
+			    "--- last 2 debug messages:\n"
+			    "dimm0: size 1000, 2 ranks, 12.5%\n"
+			    "Unable to open /dev/mem: No such file or directory\n"
+			    "--- end of debug messages\n");
+
+	/* the dump empties the recorder */
+	rewind(log_fp);
+	memset(log_text, 0, sizeof(log_text));
+	log_recorder_dump();
+	fflush(log_fp);
+	assert_string_equal(log_text, "");
+}
+
+static void recorder_keeps_last_messages(void **state)
+{
+	char *last;
+	int i;
+
+	log_recorder_reset();
+	for (i = 0; i < 1000; i++)
+		lprintf(LOG_DEBUG, "message %d\n", i);
+	log_recorder_dump();
+
+	assert_non_null(strstr(log_text, "--- last "));
+	assert_null(strstr(log_text, "message 0\n"));
+	last = strstr(log_text, "message 999\n");
+	assert_non_null(last);
+	assert_string_equal(last,
+			    "message 999\n--- end of debug messages\n");
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(level_enabled_follows_threshold,
+						log_setup, log_teardown),
+		cmocka_unit_test_setup_teardown(printed_messages_are_buffered,
+						log_setup, log_teardown),
+		cmocka_unit_test_setup_teardown(long_messages_keep_end_of_line,
+						log_setup, log_teardown),
+		cmocka_unit_test_setup_teardown(recorder_formats_on_dump,
+						log_setup, log_teardown),
+		cmocka_unit_test_setup_teardown(recorder_keeps_last_messages,
+						log_setup, log_teardown),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
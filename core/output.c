@@ -31,14 +31,333 @@
  * output.c: mosys output routines
  */
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
 
+#include "mosys/alloc.h"
+#include "mosys/context.h"
 #include "mosys/globals.h"
 #include "mosys/output.h"
 
+#include "lib/string.h"
+
+/*
+ * Output is collected in a buffer of the current context and written to
+ * the output file in bulk, with a single write(2) or writev(2) when the
+ * file has a descriptor.  Anything already in the stdio buffer of the
+ * file is flushed first, so mixing with stdio keeps the order.
+ */
+#define MOSYS_OUTPUT_BUF_SIZE	(64 * 1024)
+
+/* "00000010  xx xx ... xx  xx ... xx  |ascii...........|\n" */
+#define HEXDUMP_LINE_LEN	(10 + 16 * 3 + 1 + 20)
+
+/* write a buffer and a trailing chunk in one go */
+static int output_emit(FILE *fp, const char *buf, size_t len,
+		       const void *data, size_t data_len)
+{
+	struct iovec iov[2] = {
+		{ .iov_base = (void *)buf, .iov_len = len },
+		{ .iov_base = (void *)data, .iov_len = data_len },
+	};
+	struct iovec *v = iov;
+	int fd = fileno(fp);
+	int n = 2;
+	ssize_t ret;
+
+	if (fd < 0) {
+		/* e.g. memory streams */
+		if (fwrite(buf, 1, len, fp) != len ||
+		    fwrite(data, 1, data_len, fp) != data_len)
+			return -1;
+		return fflush(fp);
+	}
+
+	if (fflush(fp))
+		return -1;
+
+	while (n) {
+		ret = writev(fd, v, n);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+
+		/* skip what was written */
+		while (n && (size_t)ret >= v->iov_len) {
+			ret -= v->iov_len;
+			v++;
+			n--;
+		}
+		if (n) {
+			v->iov_base = (char *)v->iov_base + ret;
+			v->iov_len -= ret;
+		}
+	}
+
+	return 0;
+}
+
+int mosys_output_flush(void)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	size_t len = ctx->out_len;
+
+	if (!len)
+		return 0;
+
+	ctx->out_len = 0;
+	return output_emit(mosys_get_output_file(), ctx->out_buf, len, NULL, 0);
+}
+
+int mosys_write(const void *data, size_t len)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	size_t used = ctx->out_len;
+
+	if (!ctx->out_buf)
+		ctx->out_buf = mosys_malloc(MOSYS_OUTPUT_BUF_SIZE);
+
+	if (used + len <= MOSYS_OUTPUT_BUF_SIZE) {
+		memcpy(ctx->out_buf + used, data, len);
+		ctx->out_len += len;
+		return 0;
+	}
+
+	ctx->out_len = 0;
+	return output_emit(mosys_get_output_file(), ctx->out_buf, used,
+			   data, len);
+}
+
+int mosys_write_escaped(const char *str, char c)
+{
+	const char *p;
+	char esc[2] = { '\\', c };
+	int rc = 0;
+
+	while ((p = strchr(str, c))) {
+		rc |= mosys_write(str, p - str);
+		rc |= mosys_write(esc, sizeof(esc));
+		str = p + 1;
+	}
+
+	return rc | mosys_write(str, strlen(str));
+}
+
+/* how each byte is written in a JSON string: 0 as is, 'u' as \u00XX */
+static const char json_escapes[256] = {
+	[0x00 ... 0x1f] = 'u',
+	['\b'] = 'b',
+	['\f'] = 'f',
+	['\n'] = 'n',
+	['\r'] = 'r',
+	['\t'] = 't',
+	['"'] = '"',
+	['\\'] = '\\',
+	[0x7f] = 'u',
+	[0x80 ... 0xff] = '8',
+};
+
+/*
+ * utf8_len  -  get the length of a valid UTF-8 sequence
+ *
+ * @p:		sequence starting with a byte of 0x80 or above
+ *
+ * Overlong encodings, surrogates and code points above U+10FFFF are
+ * not valid.
+ *
+ * returns the length of the sequence, 0 if it is not valid
+ */
+static int utf8_len(const unsigned char *p)
+{
+	int len, i;
+	unsigned char lo = 0x80, hi = 0xbf;
+
+	if (p[0] >= 0xc2 && p[0] <= 0xdf)
+		len = 2;
+	else if (p[0] >= 0xe0 && p[0] <= 0xef)
+		len = 3;
+	else if (p[0] >= 0xf0 && p[0] <= 0xf4)
+		len = 4;
+	else
+		return 0;
+
+	/* the second byte rules out overlong forms and out of range values */
+	if (p[0] == 0xe0)
+		lo = 0xa0;
+	else if (p[0] == 0xed)
+		hi = 0x9f;
+	else if (p[0] == 0xf0)
+		lo = 0x90;
+	else if (p[0] == 0xf4)
+		hi = 0x8f;
+
+	if (p[1] < lo || p[1] > hi)
+		return 0;
+	for (i = 2; i < len; i++) {
+		if (p[i] < 0x80 || p[i] > 0xbf)
+			return 0;
+	}
+
+	return len;
+}
+
+/*
+ * encode a string as JSON, returns the end of the encoded string; bytes
+ * which are not valid UTF-8 are replaced with U+FFFD
+ */
+static char *json_encode(char *d, const unsigned char *p)
+{
+	static const char hex[] = "0123456789abcdef";
+	char c;
+	int n;
+
+	*d++ = '"';
+	for (; *p; p++) {
+		c = json_escapes[*p];
+		if (!c) {
+			*d++ = *p;
+			continue;
+		}
+
+		if (c == '8') {
+			n = utf8_len(p);
+			if (n) {
+				memcpy(d, p, n);
+				d += n;
+				p += n - 1;
+			} else {
+				memcpy(d, "\\ufffd", 6);
+				d += 6;
+			}
+			continue;
+		}
+
+		*d++ = '\\';
+		if (c == 'u') {
+			*d++ = 'u';
+			*d++ = '0';
+			*d++ = '0';
+			*d++ = hex[*p >> 4];
+			*d++ = hex[*p & 0xf];
+		} else {
+			*d++ = c;
+		}
+	}
+	*d++ = '"';
+
+	return d;
+}
+
+int mosys_write_json_string(const char *str)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	size_t max = strlen(str) * 6 + 2;	/* every byte as \u00XX */
+	char *tmp, *end;
+	int rc;
+
+	if (!ctx->out_buf)
+		ctx->out_buf = mosys_malloc(MOSYS_OUTPUT_BUF_SIZE);
+
+	/* encode straight into the buffer if it surely fits */
+	if (ctx->out_len + max <= MOSYS_OUTPUT_BUF_SIZE) {
+		end = json_encode(ctx->out_buf + ctx->out_len,
+				  (const unsigned char *)str);
+		ctx->out_len = end - ctx->out_buf;
+		return 0;
+	}
+
+	tmp = mosys_malloc(max);
+	end = json_encode(tmp, (const unsigned char *)str);
+	rc = mosys_write(tmp, end - tmp);
+	free(tmp);
+
+	return rc;
+}
+
+int mosys_write_cbor_head(int major, uint64_t value)
+{
+	uint8_t head[9];
+	int len, i;
+
+	if (value < 24) {
+		head[0] = major << 5 | value;
+		return mosys_write(head, 1);
+	}
+
+	/* 1, 2, 4 or 8 bytes of big-endian argument */
+	if (value <= 0xff)
+		len = 1;
+	else if (value <= 0xffff)
+		len = 2;
+	else if (value <= 0xffffffff)
+		len = 4;
+	else
+		len = 8;
+
+	head[0] = major << 5 | (len == 1 ? 24 : len == 2 ? 25 :
+				len == 4 ? 26 : 27);
+	for (i = len; i > 0; i--) {
+		head[i] = value & 0xff;
+		value >>= 8;
+	}
+
+	return mosys_write(head, len + 1);
+}
+
+int mosys_write_cbor_int(int64_t value)
+{
+	if (value < 0)
+		return mosys_write_cbor_head(CBOR_NEGATIVE, -1 - value);
+
+	return mosys_write_cbor_head(CBOR_UNSIGNED, value);
+}
+
+int mosys_write_cbor_string(const char *str)
+{
+	size_t len = strlen(str);
+
+	return mosys_write_cbor_head(CBOR_TEXT, len) | mosys_write(str, len);
+}
+
+int mosys_vprintf(const char *format, va_list ap)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	size_t room;
+	va_list aq;
+	char *tmp;
+	int len;
+
+	if (!ctx->out_buf)
+		ctx->out_buf = mosys_malloc(MOSYS_OUTPUT_BUF_SIZE);
+
+	/* format straight into the buffer if it fits */
+	room = MOSYS_OUTPUT_BUF_SIZE - ctx->out_len;
+	va_copy(aq, ap);
+	len = vsnprintf(ctx->out_buf + ctx->out_len, room, format, aq);
+	va_end(aq);
+	if (len < 0 || (size_t)len < room) {
+		if (len > 0)
+			ctx->out_len += len;
+		return len;
+	}
+
+	tmp = mosys_malloc(len + 1);
+	vsnprintf(tmp, len + 1, format, ap);
+	if (mosys_write(tmp, len) < 0)
+		len = -1;
+	free(tmp);
+
+	return len;
+}
+
 /*
  * mosys_printf - standard printf to mosys output file
  *
@@ -51,11 +370,10 @@
 int mosys_printf(const char *format, ...)
 {
 	int ret;
-	FILE *fp = mosys_get_output_file();
 	va_list arglist;
 
 	va_start(arglist, format);
-	ret = vfprintf(fp, format, arglist);
+	ret = mosys_vprintf(format, arglist);
 	va_end(arglist);
 
 	return ret;
@@ -70,52 +388,61 @@ int mosys_printf(const char *format, ...)
  */
 void print_buffer_to_file(FILE* fp, void *data, int length)
 {
-	uint8_t astr[20], val;
-	int i, ctr;
-	int extra = 0;
-	uint8_t *buffer = data;
-
-	memset(astr, 0, sizeof(astr));
-
-	/* check for 16-byte unaligned data length */
-	if (length % 16)
-		extra = 16 - (length % 16);
-
-	for (i = ctr = 0; ctr < length; ctr++) {
-		if ((ctr % 16) == 0) {
-			if (ctr != 0)
-				fprintf(fp, "\n");
-			fprintf(fp, "%08x  ", ctr);
-		} else if ((ctr % 8) == 0)
-			fprintf(fp, " ");
-
-		val = buffer[ctr];
-		fprintf(fp, "%02x ", val);
-
-		/* add to ascii string */
-		astr[i++] = ((val > 0x1f) && (val < 0x7f)) ? val : 0x2e;
-
-		if (extra && ctr == (length - 1)) {
-			/* special handling for unaligned end of data */
-			if (extra >= 8)
-				fprintf(fp, " ");
-			for (; i < 16; i++) {
-				fprintf(fp, "   ");
-				astr[i] = ' ';
-			}
-			fprintf(fp, " |%s|", astr);
-		} else {
-			/* print ascii string at end of hex line */
-			if (((ctr + 1) % 16) == 0) {
-				fprintf(fp, " |%s|", astr);
-				memset(astr, 0, sizeof(astr));
-				i = 0;
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	FILE *saved = mosys_get_output_file();
+	const uint8_t *buffer = data;
+	uint8_t offset[4];
+	int ctr, n, i;
+	char *d;
+
+	mosys_set_output_file(fp);
+	if (!ctx->out_buf)
+		ctx->out_buf = mosys_malloc(MOSYS_OUTPUT_BUF_SIZE);
+
+	for (ctr = 0; ctr < length; ctr += 16) {
+		n = length - ctr < 16 ? length - ctr : 16;
+		if (ctx->out_len + HEXDUMP_LINE_LEN > MOSYS_OUTPUT_BUF_SIZE)
+			mosys_output_flush();
+		d = ctx->out_buf + ctx->out_len;
+
+		offset[0] = ctr >> 24;
+		offset[1] = ctr >> 16;
+		offset[2] = ctr >> 8;
+		offset[3] = ctr;
+		d = hex_encode(d, offset, sizeof(offset));
+		*d++ = ' ';
+
+		for (i = 0; i < 16; i++) {
+			if (i % 8 == 0)
+				*d++ = ' ';
+			if (i < n) {
+				d = hex_encode(d, &buffer[ctr + i], 1);
+			} else {
+				*d++ = ' ';
+				*d++ = ' ';
 			}
+			*d++ = ' ';
 		}
+
+		*d++ = ' ';
+		*d++ = '|';
+		for (i = 0; i < 16; i++) {
+			if (i >= n)
+				*d++ = ' ';
+			else if (buffer[ctr + i] > 0x1f && buffer[ctr + i] < 0x7f)
+				*d++ = buffer[ctr + i];
+			else
+				*d++ = '.';
+		}
+		*d++ = '|';
+		*d++ = '\n';
+
+		ctx->out_len = d - ctx->out_buf;
 	}
 
-	fprintf(fp, "\n");
-	fflush(fp);
+	if (length <= 0)
+		mosys_write("\n", 1);
+	mosys_set_output_file(saved);
 }
 
 /*
@@ -126,6 +453,5 @@ void print_buffer_to_file(FILE* fp, void *data, int length)
  */
 void print_buffer(void *data, int length)
 {
-	FILE *fp = mosys_get_output_file();
-	print_buffer_to_file(fp, data, length);
+	print_buffer_to_file(mosys_get_output_file(), data, length);
 }
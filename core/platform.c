@@ -31,6 +31,7 @@
  */
 
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -38,56 +39,235 @@
 #include <unistd.h>
 
 #include "mosys/alloc.h"
+#include "mosys/context.h"
 #include "mosys/globals.h"
 #include "mosys/intf_list.h"
 #include "mosys/kv_pair.h"
 #include "mosys/log.h"
 #include "mosys/platform.h"
+#include "mosys/platform_cache.h"
 #include "mosys/output.h"
+#include "mosys/trace.h"
 
+#include "lib/math.h"
 #include "lib/string.h"
 
 #ifndef LINE_MAX
 #define LINE_MAX 64
 #endif
 
-static struct platform_list *platform_list;
+/* Bounds of the registry, see _REGISTER_PLATFORM; weak if it is empty */
+extern const struct platform_entry __start_mosys_platforms[]
+	__attribute__((weak));
+extern const struct platform_entry __stop_mosys_platforms[]
+	__attribute__((weak));
 
-void push_platform_intf(struct platform_intf *intf, struct platform_list *dest)
-{
-	dest->entry = intf;
-	dest->next = platform_list;
-	platform_list = dest;
-}
+/*
+ * Walk the registered platforms in probe order, skipping those disabled
+ * in this build.  Entries are laid out in link order and walked from
+ * the end, which is the order platforms have always been probed in.
+ */
+#define for_each_platform(e)						\
+	for ((e) = __stop_mosys_platforms;				\
+	     (e) != __start_mosys_platforms && ((e)--, 1);)		\
+		if (!(e)->intf) {} else
 
 /*
  * Internal function used by mosys_platform_setup to search for a
- * supported platform by name
+ * supported platform by the name it registered as
  */
 static struct platform_intf *find_platform_by_name(const char *platform_name)
 {
-	for (struct platform_list *p = platform_list; p; p = p->next) {
-		struct platform_intf *intf = p->entry;
-		if (!strcasecmp(intf->name, platform_name))
-			return intf;
-		continue;
+	const struct platform_entry *e;
+
+	for_each_platform(e) {
+		if (!strcasecmp(e->name, platform_name))
+			return e->intf;
 	}
 
 	return NULL;
 }
 
+/*
+ * Internal function used by mosys_platform_setup to save the result of
+ * probing to the boot cache
+ *
+ * @platform is the name the platform was registered under, which the
+ * probe function may have changed in intf->name.
+ */
+static void save_probed_platform(const char *platform,
+				 struct platform_intf *intf)
+{
+	if (mosys_get_use_platform_cache())
+		platform_cache_update(platform, intf->name, intf->sku_info);
+}
+
+/*
+ * Internal function used by mosys_platform_setup to restore the result
+ * of probing from the boot cache, without calling any probe function
+ */
+static struct platform_intf *find_cached_platform(void)
+{
+	const char *platform, *name;
+	const struct sku_info *sku_info;
+	struct platform_intf *intf;
+
+	if (!mosys_get_use_platform_cache() ||
+	    platform_cache_lookup(&platform, &name, &sku_info) < 0)
+		return NULL;
+
+	intf = find_platform_by_name(platform);
+	if (!intf)
+		return NULL;
+
+	lprintf(LOG_DEBUG, "Platform %s found (via boot cache)\n", name);
+	intf->name = name;
+	intf->sku_info = sku_info;
+	return intf;
+}
+
+#ifdef CONFIG_PARALLEL_PROBE
+/* Maximum number of platforms probed at the same time */
+#define PROBE_THREADS	4
+
+struct probe_job {
+	struct platform_intf *intf;
+	const char *platform;	/* name registered, before probing */
+	int rc;			/* result of intf->probe */
+	bool done;
+};
+
+struct probe_pool {
+	pthread_mutex_t lock;
+	pthread_cond_t job_done;
+	struct probe_job *jobs;
+	int num_jobs;
+	int next_job;		/* next job to be picked up by a worker */
+	bool stop;		/* a platform matched, skip the rest */
+	struct mosys_ctx *ctx;	/* context of the thread probing */
+};
+
+static void *probe_worker(void *arg)
+{
+	struct probe_pool *pool = arg;
+
+	mosys_ctx_set(pool->ctx);
+	pthread_mutex_lock(&pool->lock);
+	while (!pool->stop && pool->next_job < pool->num_jobs) {
+		struct probe_job *job = &pool->jobs[pool->next_job++];
+		int trace_id, rc;
+
+		pthread_mutex_unlock(&pool->lock);
+		trace_id = trace_begin("probe", job->platform);
+		rc = job->intf->probe(job->intf);
+		trace_end(trace_id);
+		pthread_mutex_lock(&pool->lock);
+
+		job->rc = rc;
+		job->done = true;
+		pthread_cond_broadcast(&pool->job_done);
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	return NULL;
+}
+
+/*
+ * Internal function used by mosys_platform_setup to probe the platforms
+ * concurrently.  Jobs are handed out and their results consumed in list
+ * order, so the first platform in the list which matches wins, no matter
+ * which probe finishes first.  Once it is known, no new probes are
+ * started, but those already running are waited for.
+ */
+static struct platform_intf *probe_platform(void)
+{
+	struct probe_pool pool = {
+		.lock = PTHREAD_MUTEX_INITIALIZER,
+		.job_done = PTHREAD_COND_INITIALIZER,
+		.ctx = mosys_ctx_get(),
+	};
+	pthread_t threads[PROBE_THREADS];
+	const struct platform_entry *e;
+	struct platform_intf *intf = NULL;
+	struct probe_job *found = NULL;
+	int num_threads = 0;
+	int i;
+
+	for_each_platform(e) {
+		if (e->intf->probe)
+			pool.num_jobs++;
+	}
+	if (!pool.num_jobs)
+		return NULL;
+
+	pool.jobs = mosys_zalloc(pool.num_jobs * sizeof(*pool.jobs));
+	i = 0;
+	for_each_platform(e) {
+		if (!e->intf->probe)
+			continue;
+		pool.jobs[i].intf = e->intf;
+		pool.jobs[i].platform = e->name;
+		i++;
+	}
+
+	while (num_threads < __min(PROBE_THREADS, pool.num_jobs) &&
+	       !pthread_create(&threads[num_threads], NULL,
+			       probe_worker, &pool))
+		num_threads++;
+
+	/* Fall back to probing one by one if no thread could be started */
+	if (!num_threads)
+		probe_worker(&pool);
+
+	pthread_mutex_lock(&pool.lock);
+	for (i = 0; i < pool.num_jobs && !found; i++) {
+		struct probe_job *job = &pool.jobs[i];
+
+		while (!job->done)
+			pthread_cond_wait(&pool.job_done, &pool.lock);
+
+		if (job->rc < 0) {
+			lprintf(LOG_DEBUG, "Error encountered when "
+				"probing %s\n", job->intf->name);
+		} else if (job->rc > 0) {
+			lprintf(LOG_DEBUG, "Platform %s found (via "
+				"probing)\n", job->intf->name);
+			found = job;
+		}
+	}
+	pool.stop = true;
+	pthread_mutex_unlock(&pool.lock);
+
+	for (i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	if (found) {
+		save_probed_platform(found->platform, found->intf);
+		intf = found->intf;
+	}
+
+	free(pool.jobs);
+	return intf;
+}
+#else
 /*
  * Internal function used by mosys_platform_setup to probe each
  * platform until one matches
  */
 static struct platform_intf *probe_platform(void)
 {
-	for (struct platform_list *p = platform_list; p; p = p->next) {
-		struct platform_intf *intf = p->entry;
+	const struct platform_entry *e;
+
+	for_each_platform(e) {
+		struct platform_intf *intf = e->intf;
 
 		if (intf->probe) {
+			const char *platform = e->name;
+			int trace_id = trace_begin("probe", platform);
 			int rc = intf->probe(intf);
 
+			trace_end(trace_id);
+
 			if (rc < 0) {
 				lprintf(LOG_DEBUG, "Error encountered when "
 					"probing %s\n", intf->name);
@@ -95,6 +275,7 @@ static struct platform_intf *probe_platform(void)
 			} else if (rc > 0) {
 				lprintf(LOG_DEBUG, "Platform %s found (via "
 					"probing)\n", intf->name);
+				save_probed_platform(platform, intf);
 				return intf;
 			}
 		}
@@ -102,6 +283,7 @@ static struct platform_intf *probe_platform(void)
 
 	return NULL;
 }
+#endif /* CONFIG_PARALLEL_PROBE */
 
 /*
  * mosys_platform_setup  -  identify platform, setup interfaces and commands
@@ -114,25 +296,29 @@ static struct platform_intf *probe_platform(void)
  */
 struct platform_intf *mosys_platform_setup(const char *platform_name)
 {
-	struct platform_intf *intf;
+	const struct platform_entry *e;
+	struct platform_intf *intf, *only_intf = NULL;
 	int platform_count = 0;
 	bool probe_called = false;
 
 	/* setup defaults for each platform */
-	for (struct platform_list *p = platform_list; p; p = p->next) {
-		intf = p->entry;
+	for_each_platform(e) {
+		intf = e->intf;
 		if (!intf->name)
-			intf->name = "";
+			intf->name = e->name;
 		if (!intf->op)
 			intf->op = &platform_common_op;
 
+		only_intf = intf;
 		platform_count++;
 	}
 
 	if (platform_name) {
 		intf = find_platform_by_name(platform_name);
+	} else if ((intf = find_cached_platform())) {
+		probe_called = true;
 	} else if (platform_count == 1) {
-		intf = platform_list->entry;
+		intf = only_intf;
 	} else {
 		intf = probe_platform();
 		probe_called = true;
@@ -151,10 +337,17 @@ struct platform_intf *mosys_platform_setup(const char *platform_name)
 	 * We setup the platform_intf anyway, but provide a warning.
 	 */
 	if (!probe_called && intf->probe) {
-		if (intf->probe(intf) <= 0) {
+		const char *platform = intf->name;
+		int trace_id = trace_begin("probe", intf->name);
+		int rc = intf->probe(intf);
+
+		trace_end(trace_id);
+		if (rc <= 0) {
 			lprintf(LOG_ERR,
 				"Platform probe function failed. "
 				"Model-specific commands may be incorrect.\n");
+		} else if (!platform_name) {
+			save_probed_platform(platform, intf);
 		}
 	}
 
@@ -207,7 +400,76 @@ void mosys_platform_destroy(struct platform_intf *intf)
  */
 void platform_cmd_usage(struct platform_cmd *cmd)
 {
-	printf("usage: %s %s\n\n", cmd->name, cmd->usage ? : "");
+	mosys_printf("usage: %s %s\n\n", cmd->name, cmd->usage ? : "");
+}
+
+/* cheap first-character test before the full comparison */
+static int cmd_name_matches(const struct platform_cmd *cmd, const char *name)
+{
+	return cmd->name[0] == name[0] && !strcmp(cmd->name, name);
+}
+
+struct platform_cmd *platform_find_root_cmd(struct platform_intf *intf,
+					    const char *name)
+{
+	struct platform_cmd **root;
+
+	if (!intf || !intf->sub)
+		return NULL;
+
+	for (root = intf->sub; *root; root++) {
+		if (cmd_name_matches(*root, name))
+			return *root;
+	}
+
+	return NULL;
+}
+
+struct platform_cmd *platform_find_sub_cmd(struct platform_cmd *cmd,
+					   const char *name)
+{
+	struct platform_cmd *sub;
+
+	if (!cmd || cmd->type != ARG_TYPE_SUB)
+		return NULL;
+
+	for (sub = cmd->arg.sub; sub && sub->name; sub++) {
+		if (cmd_name_matches(sub, name))
+			return sub;
+	}
+
+	return NULL;
+}
+
+/*
+ * platform_find_cmd  -  resolve a command line to the command it runs
+ *
+ * @intf:	platform interface
+ * @argc:	number of command words
+ * @argv:	command words
+ *
+ * returns the getter or setter which the command words lead to
+ * returns NULL if they do not lead to one
+ */
+struct platform_cmd *platform_find_cmd(struct platform_intf *intf,
+				       int argc, char **argv)
+{
+	struct platform_cmd *cmd;
+
+	if (argc < 1)
+		return NULL;
+
+	cmd = platform_find_root_cmd(intf, argv[0]);
+	while (cmd && cmd->type == ARG_TYPE_SUB) {
+		argc--;
+		argv++;
+		if (argc < 1)
+			return NULL;
+
+		cmd = platform_find_sub_cmd(cmd, argv[0]);
+	}
+
+	return cmd;
 }
 
 /*
@@ -234,13 +496,13 @@ static int tree_subcommand(struct platform_intf *intf,
 	tabs[depth] = '\0';
 
 	for (sub = cmd->arg.sub, index = 1; sub->name != NULL; sub++, index++) {
-		printf("%s", tabs);
+		mosys_printf("%s", tabs);
 
 		if (sub->type == ARG_TYPE_SUB) {
 			int pos = 0, len = 0;
 
 			if (mosys_get_verbosity() >= LOG_NOTICE) {
-				printf("[branch] %s ", str);
+				mosys_printf("[branch] %s ", str);
 
 				/* add full command info */
 				pos = strlen(str);
@@ -248,7 +510,7 @@ static int tree_subcommand(struct platform_intf *intf,
 				snprintf(str + pos, len, " %s", sub->name);
 			}
 
-			printf("%s\n", sub->name);
+			mosys_printf("%s\n", sub->name);
 
 			/* continue descending into the hierarchy */
 			tree_subcommand(intf, sub, depth + 1, str);
@@ -258,12 +520,12 @@ static int tree_subcommand(struct platform_intf *intf,
 			}
 		} else if (sub->type == ARG_TYPE_GETTER) {
 			if (mosys_get_verbosity() >= LOG_NOTICE)
-				printf("[leaf] %s ", str);
-			printf("%s\n", sub->name);
+				mosys_printf("[leaf] %s ", str);
+			mosys_printf("%s\n", sub->name);
 		} else if (sub->type == ARG_TYPE_SETTER) {
 			if (mosys_get_verbosity() >= LOG_NOTICE)
-				printf("[flur] %s ", str);
-			printf("%s\n", sub->name);
+				mosys_printf("[flur] %s ", str);
+			mosys_printf("%s\n", sub->name);
 		} else {
 			// not a subcommand or function?!?
 			return -1;
@@ -287,13 +549,13 @@ void print_tree(struct platform_intf *intf)
 
 	for (root = 0; intf->sub[root] != NULL; root++) {
 		if (mosys_get_verbosity() >= LOG_NOTICE) {
-			printf("[root] ");
+			mosys_printf("[root] ");
 			snprintf(str, sizeof(str), "mosys %s",
 						   intf->sub[root]->name);
 		} else {
 			snprintf(str, sizeof(str), "%s", intf->sub[root]->name);
 		}
-		printf("%s\n", str);
+		mosys_printf("%s\n", str);
 
 		if (tree_subcommand(intf, intf->sub[root], 1, str) < 0)
 			lprintf(LOG_DEBUG, "tree walking failed: %s", str);
@@ -307,23 +569,25 @@ void print_tree(struct platform_intf *intf)
  * returns <0 to indicate failure
  */
 int print_platforms() {
+	const struct platform_entry *e;
 	struct kv_pair *kv;
-	int rc;
+	int rc = 0;
 
-	/* go through all supported interfaces */
-	for (struct platform_list *p = platform_list; p; p = p->next) {
-		struct platform_intf *intf = p->entry;
+	kv_pair_output_begin(NULL, 1);
 
-		if (intf->type == PLATFORM_DEFAULT)
+	/* go through all supported interfaces */
+	for_each_platform(e) {
+		if (e->intf->type == PLATFORM_DEFAULT)
 			continue;
 
 		kv = kv_pair_new();
-		kv_pair_add(kv, "id", intf->name);
+		kv_pair_add(kv, "id", e->name);
 		rc = kv_pair_print(kv);
 		kv_pair_free(kv);
 		if (rc)
-			return rc;
+			break;
 	}
 
+	kv_pair_output_end();
 	return rc;
 }
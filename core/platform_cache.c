@@ -0,0 +1,279 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * platform_cache.c: boot-scoped cache of the platform identification
+ *
+ * The cache is a small text file of key=value lines.  It starts with a
+ * format magic and the key it is valid for (boot ID, FRID and identity
+ * of the mosys binary), followed by the probe results, and ends with a
+ * checksum of everything before it:
+ *
+ *   mosys-platform-cache 1
+ *   boot_id=0c4ec7a9-...
+ *   frid=Google_Rambi.5216.198.0
+ *   exe=2049:1234:1590000000
+ *   platform=Rambi
+ *   name=Banjo
+ *   sku_info=1
+ *   model=banjo
+ *   checksum=5b7e31f2
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "mosys/alloc.h"
+#include "mosys/log.h"
+#include "mosys/platform_cache.h"
+
+#include "lib/chromeos.h"
+#include "lib/file.h"
+#include "lib/probe.h"
+#include "lib/sku.h"
+
+#define PLATFORM_CACHE_MAGIC	"mosys-platform-cache 1\n"
+#define PLATFORM_CACHE_MAX	4096
+#define BOOT_ID_PATH		"/proc/sys/kernel/random/boot_id"
+
+/* strip trailing whitespace, such as the newline at the end of boot_id */
+static void strip_trailing(char *str)
+{
+	size_t len = strlen(str);
+
+	while (len && (str[len - 1] == '\n' || str[len - 1] == ' '))
+		str[--len] = '\0';
+}
+
+/*
+ * platform_cache_key  -  print the magic and key the cache must match
+ *
+ * @buf:	buffer to print into
+ * @size:	size of @buf
+ *
+ * returns the length of the key
+ * returns <0 if the key cannot be determined
+ */
+static int platform_cache_key(char *buf, size_t size)
+{
+	char boot_id[64];
+	char frid[CHROMEOS_FRID_MAXLEN + 1] = "";
+	struct stat st;
+	int fd, len;
+
+	if (read_file(BOOT_ID_PATH, boot_id, sizeof(boot_id), LOG_DEBUG) < 0)
+		return -1;
+	strip_trailing(boot_id);
+
+	/* Not all systems have a FRID, in which case the boot ID suffices */
+	if (get_frid(frid, sizeof(frid)) < 0)
+		frid[0] = '\0';
+	strip_trailing(frid);
+
+	/* Results may differ between mosys builds */
+	fd = open("/proc/self/exe", O_RDONLY);
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return -1;
+	}
+	close(fd);
+
+	len = snprintf(buf, size,
+		       PLATFORM_CACHE_MAGIC
+		       "boot_id=%s\nfrid=%s\nexe=%ju:%ju:%jd\n",
+		       boot_id, frid, (uintmax_t)st.st_dev,
+		       (uintmax_t)st.st_ino, (intmax_t)st.st_mtime);
+	if (len < 0 || len >= size)
+		return -1;
+
+	return len;
+}
+
+/* 32-bit FNV-1a, to catch truncated or corrupted files */
+static uint32_t platform_cache_checksum(const char *data, size_t len)
+{
+	uint32_t hash = 2166136261u;
+
+	while (len--) {
+		hash ^= (uint8_t)*data++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+int platform_cache_lookup(const char **platform, const char **name,
+			  const struct sku_info **sku_info)
+{
+	char buf[PLATFORM_CACHE_MAX + 1];
+	char key[PLATFORM_CACHE_MAX];
+	struct sku_info *sku = NULL;
+	struct stat st;
+	ssize_t len;
+	int key_len, fd;
+	uint32_t checksum;
+	char *line, *end, *sum;
+
+	*platform = *name = NULL;
+
+	fd = open(MOSYS_PLATFORM_CACHE_PATH, O_RDONLY);
+	if (fd < 0)
+		return -1;
+
+	/* Only trust a cache which nobody else could have written */
+	if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) ||
+	    (st.st_uid != 0 && st.st_uid != geteuid()) ||
+	    (st.st_mode & (S_IWGRP | S_IWOTH))) {
+		lprintf(LOG_DEBUG, "%s: Ignoring untrusted %s\n",
+			__func__, MOSYS_PLATFORM_CACHE_PATH);
+		close(fd);
+		return -1;
+	}
+
+	len = read(fd, buf, PLATFORM_CACHE_MAX);
+	close(fd);
+	if (len <= 0)
+		return -1;
+	buf[len] = '\0';
+
+	/* The checksum line must come last, and cover everything else */
+	sum = strstr(buf, "checksum=");
+	if (!sum || (sum != buf && sum[-1] != '\n') ||
+	    strlen(sum) != sizeof("checksum=00000000\n") - 1 ||
+	    sscanf(sum, "checksum=%" SCNx32 "\n", &checksum) != 1 ||
+	    platform_cache_checksum(buf, sum - buf) != checksum) {
+		lprintf(LOG_DEBUG, "%s: Corrupted %s\n",
+			__func__, MOSYS_PLATFORM_CACHE_PATH);
+		return -1;
+	}
+	*sum = '\0';
+
+	key_len = platform_cache_key(key, sizeof(key));
+	if (key_len < 0 || strncmp(buf, key, key_len)) {
+		lprintf(LOG_DEBUG, "%s: Stale %s\n",
+			__func__, MOSYS_PLATFORM_CACHE_PATH);
+		return -1;
+	}
+
+	for (line = buf + key_len; *line; line = end + 1) {
+		char *value;
+
+		end = strchr(line, '\n');
+		if (!end)
+			break;
+		*end = '\0';
+
+		value = strchr(line, '=');
+		if (!value)
+			continue;
+		*value++ = '\0';
+
+		if (!strcmp(line, "platform"))
+			*platform = mosys_strdup(value);
+		else if (!strcmp(line, "name"))
+			*name = mosys_strdup(value);
+		else if (!strcmp(line, "sku_info"))
+			sku = mosys_zalloc(sizeof(*sku));
+		else if (sku && !strcmp(line, "brand"))
+			sku->brand = mosys_strdup(value);
+		else if (sku && !strcmp(line, "model"))
+			sku->model = mosys_strdup(value);
+		else if (sku && !strcmp(line, "chassis"))
+			sku->chassis = mosys_strdup(value);
+		else if (sku && !strcmp(line, "customization"))
+			sku->customization = mosys_strdup(value);
+	}
+
+	if (!*platform || !*name)
+		return -1;
+
+	*sku_info = sku;
+	return 0;
+}
+
+/* append a key=value line, refusing values which would break the format */
+static int platform_cache_add(char *buf, size_t size, size_t *len,
+			      const char *key, const char *value)
+{
+	int n;
+
+	if (!value)
+		return 0;
+	if (strchr(value, '\n'))
+		return -1;
+
+	n = snprintf(buf + *len, size - *len, "%s=%s\n", key, value);
+	if (n < 0 || n >= size - *len)
+		return -1;
+
+	*len += n;
+	return 0;
+}
+
+void platform_cache_update(const char *platform, const char *name,
+			   const struct sku_info *sku_info)
+{
+	char buf[PLATFORM_CACHE_MAX];
+	char tmp_path[sizeof(MOSYS_PLATFORM_CACHE_PATH) + 16];
+	size_t len;
+	int key_len, fd, rc = 0;
+
+	key_len = platform_cache_key(buf, sizeof(buf));
+	if (key_len < 0)
+		return;
+	len = key_len;
+
+	rc |= platform_cache_add(buf, sizeof(buf), &len, "platform", platform);
+	rc |= platform_cache_add(buf, sizeof(buf), &len, "name", name);
+	if (sku_info) {
+		rc |= platform_cache_add(buf, sizeof(buf), &len,
+					 "sku_info", "1");
+		rc |= platform_cache_add(buf, sizeof(buf), &len,
+					 "brand", sku_info->brand);
+		rc |= platform_cache_add(buf, sizeof(buf), &len,
+					 "model", sku_info->model);
+		rc |= platform_cache_add(buf, sizeof(buf), &len,
+					 "chassis", sku_info->chassis);
+		rc |= platform_cache_add(buf, sizeof(buf), &len,
+					 "customization",
+					 sku_info->customization);
+	}
+	if (rc < 0 || len + sizeof("checksum=00000000\n") > sizeof(buf))
+		return;
+	len += snprintf(buf + len, sizeof(buf) - len,
+			"checksum=%08" PRIx32 "\n",
+			platform_cache_checksum(buf, len));
+
+	/* Write a new file and rename it, so readers never see a partial one */
+	snprintf(tmp_path, sizeof(tmp_path), "%s.%d",
+		 MOSYS_PLATFORM_CACHE_PATH, getpid());
+	fd = open(tmp_path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+	if (fd < 0) {
+		lperror(LOG_DEBUG, "%s: Unable to create %s", __func__,
+			tmp_path);
+		return;
+	}
+
+	if (write(fd, buf, len) != len) {
+		lperror(LOG_DEBUG, "%s: Unable to write %s", __func__,
+			tmp_path);
+		close(fd);
+		unlink(tmp_path);
+		return;
+	}
+	close(fd);
+
+	if (rename(tmp_path, MOSYS_PLATFORM_CACHE_PATH) < 0) {
+		lperror(LOG_DEBUG, "%s: Unable to rename %s", __func__,
+			tmp_path);
+		unlink(tmp_path);
+	}
+}
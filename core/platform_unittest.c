@@ -26,6 +26,33 @@
 #include "mosys/globals.h"
 #include "mosys/intf_list.h"
 #include "mosys/platform.h"
+#include "mosys/platform_cache.h"
+
+typeof(platform_cache_lookup) __wrap_platform_cache_lookup;
+typeof(platform_cache_update) __wrap_platform_cache_update;
+
+/* Fake boot cache, which is empty unless cached_platform is set */
+static const char *cached_platform;
+static const char *cached_name;
+
+int __wrap_platform_cache_lookup(const char **platform, const char **name,
+				 const struct sku_info **sku_info)
+{
+	if (!cached_platform)
+		return -1;
+
+	*platform = cached_platform;
+	*name = cached_name;
+	*sku_info = NULL;
+	return 0;
+}
+
+void __wrap_platform_cache_update(const char *platform, const char *name,
+				  const struct sku_info *sku_info)
+{
+	cached_platform = platform;
+	cached_name = name;
+}
 
 /* Subcommands list used for testing which defines no commands */
 static struct platform_cmd *no_subcommands[] = {
@@ -268,7 +295,10 @@ static void probe_matches(void **state)
 {
 	probe_mocked_match_enable = true;
 	assert_ptr_equal(mosys_platform_setup(NULL), &mocked_match_intf);
+#ifndef CONFIG_PARALLEL_PROBE
+	/* Parallel probing may go on to probe the platforms after it */
 	assert_ptr_equal(probe_called, &mocked_match_intf);
+#endif
 	assert_ptr_equal(setup_called, &mocked_match_intf);
 	assert_null(destroy_called);
 	assert_ptr_equal(setup_post_called, &mocked_match_intf);
@@ -290,6 +320,55 @@ static void probe_fails(void **state)
 	probe_called = NULL;
 }
 
+static void probe_result_is_cached(void **state)
+{
+	mosys_set_use_platform_cache(1);
+	probe_mocked_match_enable = true;
+	assert_ptr_equal(mosys_platform_setup(NULL), &mocked_match_intf);
+#ifndef CONFIG_PARALLEL_PROBE
+	/* Parallel probing may go on to probe the platforms after it */
+	assert_ptr_equal(probe_called, &mocked_match_intf);
+#endif
+	assert_string_equal(cached_platform, "mocked_match");
+	assert_string_equal(cached_name, "mocked_match");
+
+	probe_called = NULL;
+	setup_called = NULL;
+	setup_post_called = NULL;
+	probe_mocked_match_enable = false;
+	cached_platform = NULL;
+	mosys_set_use_platform_cache(0);
+}
+
+static void cached_platform_skips_probe(void **state)
+{
+	mosys_set_use_platform_cache(1);
+	cached_platform = "basic";
+	cached_name = "Cached Name";
+	assert_ptr_equal(mosys_platform_setup(NULL), &basic_intf);
+	assert_null(probe_called);
+	assert_ptr_equal(setup_called, &basic_intf);
+	assert_string_equal(basic_intf.name, "Cached Name");
+
+	basic_intf.name = "basic";
+	setup_called = NULL;
+	setup_post_called = NULL;
+	cached_platform = NULL;
+	mosys_set_use_platform_cache(0);
+}
+
+static void cache_ignored_when_disabled(void **state)
+{
+	cached_platform = "basic";
+	cached_name = "Cached Name";
+	assert_null(mosys_platform_setup(NULL));
+	assert_non_null(probe_called);
+	assert_string_equal(basic_intf.name, "basic");
+
+	probe_called = NULL;
+	cached_platform = NULL;
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
@@ -302,6 +381,9 @@ int main(void)
 		cmocka_unit_test(setup_post_error_fails_no_destroy),
 		cmocka_unit_test(probe_matches),
 		cmocka_unit_test(probe_fails),
+		cmocka_unit_test(probe_result_is_cached),
+		cmocka_unit_test(cached_platform_skips_probe),
+		cmocka_unit_test(cache_ignored_when_disabled),
 	};
 
 	return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,253 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * trace.c: per-phase latency tracing
+ *
+ * Spans are kept in one growing array in the order they were opened.
+ * Nesting is implied by the depth recorded when each span was opened,
+ * which is all the summary table and the Chrome trace viewer need.
+ * Spans may be opened from several threads (e.g. parallel probing), so
+ * the array is locked and the depth is tracked per thread.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+
+#include "mosys/alloc.h"
+#include "mosys/log.h"
+#include "mosys/trace.h"
+
+struct trace_span {
+	const char *cat;
+	const char *name;
+	uint64_t start;
+	uint64_t end;		/* 0 while the span is still open */
+	int depth;
+	pid_t tid;
+};
+
+int mosys_trace_on;
+
+static struct trace_span *trace_spans;
+static int trace_num_spans;
+static int trace_max_spans;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread int trace_depth;
+
+/* span passed to trace_add_early(), recorded once tracing is enabled */
+static struct trace_span trace_early;
+
+void trace_enable(void)
+{
+	if (mosys_trace_on)
+		return;
+	mosys_trace_on = 1;
+
+	if (trace_early.name) {
+		trace_add(trace_early.cat, trace_early.name,
+			  trace_early.start, trace_early.end);
+		trace_early.name = NULL;
+	}
+}
+
+uint64_t trace_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* must be called with trace_lock held, returns the new span's id */
+static int trace_new_span(const char *cat, const char *name,
+			  uint64_t start, uint64_t end)
+{
+	struct trace_span *span;
+
+	if (trace_num_spans == trace_max_spans) {
+		trace_max_spans = trace_max_spans ? trace_max_spans * 2 : 64;
+		trace_spans = mosys_realloc(trace_spans, trace_max_spans *
+					    sizeof(*trace_spans));
+	}
+
+	span = &trace_spans[trace_num_spans];
+	span->cat = cat;
+	span->name = name;
+	span->start = start;
+	span->end = end;
+	span->depth = trace_depth;
+	span->tid = syscall(SYS_gettid);
+	return trace_num_spans++;
+}
+
+void trace_add(const char *cat, const char *name, uint64_t start, uint64_t end)
+{
+	if (!mosys_trace_on)
+		return;
+
+	pthread_mutex_lock(&trace_lock);
+	trace_new_span(cat, name, start, end);
+	pthread_mutex_unlock(&trace_lock);
+}
+
+void trace_add_early(const char *cat, const char *name,
+		     uint64_t start, uint64_t end)
+{
+	if (mosys_trace_on) {
+		trace_add(cat, name, start, end);
+		return;
+	}
+
+	trace_early.cat = cat;
+	trace_early.name = name;
+	trace_early.start = start;
+	trace_early.end = end;
+}
+
+int trace_span_begin(const char *cat, const char *name)
+{
+	uint64_t start = trace_now();
+	int id;
+
+	pthread_mutex_lock(&trace_lock);
+	id = trace_new_span(cat, name, start, 0);
+	pthread_mutex_unlock(&trace_lock);
+
+	trace_depth++;
+	return id;
+}
+
+void trace_span_end(int id)
+{
+	uint64_t end = trace_now();
+
+	pthread_mutex_lock(&trace_lock);
+	if (id < trace_num_spans)
+		trace_spans[id].end = end;
+	pthread_mutex_unlock(&trace_lock);
+
+	if (trace_depth > 0)
+		trace_depth--;
+}
+
+static uint64_t trace_span_duration(const struct trace_span *span)
+{
+	uint64_t end = span->end ? : trace_now();
+
+	return end - span->start;
+}
+
+static int trace_same_span(const struct trace_span *a,
+			   const struct trace_span *b)
+{
+	return !strcmp(a->cat, b->cat) && !strcmp(a->name, b->name);
+}
+
+void trace_print_summary(FILE *fp)
+{
+	struct trace_total {
+		const struct trace_span *first;
+		uint64_t total;
+		uint64_t max;
+		int calls;
+	} *totals;
+	int i, j, num_totals = 0;
+
+	/* spans are listed in the order they first occurred */
+	totals = mosys_zalloc((trace_num_spans + 1) * sizeof(*totals));
+	for (i = 0; i < trace_num_spans; i++) {
+		const struct trace_span *span = &trace_spans[i];
+		uint64_t duration = trace_span_duration(span);
+
+		for (j = 0; j < num_totals; j++) {
+			if (trace_same_span(totals[j].first, span))
+				break;
+		}
+		if (j == num_totals)
+			totals[num_totals++].first = span;
+
+		totals[j].total += duration;
+		if (duration > totals[j].max)
+			totals[j].max = duration;
+		totals[j].calls++;
+	}
+
+	fprintf(fp, "%-12s %-32s %8s %12s %12s\n",
+		"category", "span", "calls", "total(ms)", "max(ms)");
+	for (j = 0; j < num_totals; j++) {
+		const struct trace_span *span = totals[j].first;
+
+		fprintf(fp, "%-12s %*s%-*s %8d %12.3f %12.3f\n",
+			span->cat, span->depth * 2, "",
+			32 - span->depth * 2, span->name, totals[j].calls,
+			totals[j].total / 1e6, totals[j].max / 1e6);
+	}
+
+	free(totals);
+}
+
+static void trace_json_string(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			fputc('\\', fp);
+		if ((unsigned char)*str < 0x20)
+			fprintf(fp, "\\u%04x", *str);
+		else
+			fputc(*str, fp);
+	}
+	fputc('"', fp);
+}
+
+int trace_write_json(const char *path)
+{
+	FILE *fp;
+	int i, pid = getpid();
+
+	fp = fopen(path, "w");
+	if (!fp) {
+		lperror(LOG_ERR, "Unable to open trace file %s", path);
+		return -1;
+	}
+
+	fprintf(fp, "{\"traceEvents\":[\n");
+	for (i = 0; i < trace_num_spans; i++) {
+		const struct trace_span *span = &trace_spans[i];
+
+		fprintf(fp, "{\"name\":");
+		trace_json_string(fp, span->name);
+		fprintf(fp, ",\"cat\":");
+		trace_json_string(fp, span->cat);
+		fprintf(fp, ",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+			"\"ts\":%.3f,\"dur\":%.3f}%s\n",
+			pid, span->tid, span->start / 1e3,
+			trace_span_duration(span) / 1e3,
+			i < trace_num_spans - 1 ? "," : "");
+	}
+	fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+
+	if (fclose(fp) != 0) {
+		lperror(LOG_ERR, "Unable to write trace file %s", path);
+		return -1;
+	}
+
+	return 0;
+}
+
+void trace_reset(void)
+{
+	free(trace_spans);
+	trace_spans = NULL;
+	trace_num_spans = 0;
+	trace_max_spans = 0;
+	trace_depth = 0;
+}
@@ -35,6 +35,7 @@
 #include <inttypes.h>
 
 #include "mosys/alloc.h"
+#include "mosys/globals.h"
 #include "mosys/kv_pair.h"
 #include "mosys/log.h"
 #include "mosys/platform.h"
@@ -102,7 +103,8 @@ int cros_ec_board_version(struct ec_cb *ec)
 	MOSYS_CHECK(priv->cmd);
 	rc = priv->cmd(ec, EC_CMD_GET_BOARD_VERSION, 0, &r, sizeof(r), NULL, 0);
 
-	if (ec->destroy && ec->destroy(ec) < 0) {
+	if (!mosys_get_keep_devices_open() &&
+	    ec->destroy && ec->destroy(ec) < 0) {
 		lprintf(LOG_ERR, "%s: EC destroy failed!\n", __func__);
 		return -1;
 	}
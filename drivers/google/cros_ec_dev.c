@@ -38,9 +38,11 @@
 #include <sys/ioctl.h>
 
 #include "mosys/alloc.h"
+#include "mosys/counters.h"
 #include "mosys/globals.h"
 #include "mosys/log.h"
 #include "mosys/platform.h"
+#include "mosys/trace.h"
 
 #include "drivers/google/cros_ec.h"
 #include "drivers/google/cros_ec_dev.h"
@@ -121,6 +123,9 @@ static int cros_ec_command_dev(struct ec_cb *ec, int command, int version,
 	struct cros_ec_priv *priv;
 	struct cros_ec_command cmd;
 	int ret;
+	TRACE_SCOPE("ec", __func__);
+
+	counter_add(COUNTER_EC_COMMANDS, 1);
 
 	MOSYS_DCHECK(ec && ec->priv);
 	priv = ec->priv;
@@ -205,6 +210,9 @@ static int cros_ec_command_dev_v2(struct ec_cb *ec, int command, int version,
 	int size = sizeof(struct cros_ec_command_v2) + __max(outsize, insize);
 	int ret;
 	uint32_t result;
+	TRACE_SCOPE("ec", __func__);
+
+	counter_add(COUNTER_EC_COMMANDS, 1);
 
 	MOSYS_DCHECK(ec && ec->priv);
 	priv = ec->priv;
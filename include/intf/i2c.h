@@ -39,8 +39,6 @@
 #include <inttypes.h>
 #include <errno.h>
 
-#define I2C_HANDLE_MAX		64
-
 struct platform_intf;
 struct i2c_intf {
 	const char *sys_root;
@@ -52,6 +52,30 @@ struct elog_header {
 	uint8_t reserved[2];
 } __attribute__ ((packed));
 
+/*
+ * Fields elog_print_data() adds to the records of "eventlog list", with
+ * the types of their values.  The schema of the command and the check
+ * whether -s wants any data at all are both built from this list, so a
+ * decoder printing a new field only needs it added here, at the end.
+ */
+#define ELOG_DATA_FIELDS(field)				\
+	field("bytes",			KV_TYPE_INT)	\
+	field("count",			KV_TYPE_INT)	\
+	field("code",			KV_TYPE_INT)	\
+	field("desc",			KV_TYPE_STRING)	\
+	field("extra",			KV_TYPE_INT)	\
+	field("device",			KV_TYPE_STRING)	\
+	field("path",			KV_TYPE_STRING)	\
+	field("event",			KV_TYPE_STRING)	\
+	field("state",			KV_TYPE_STRING)	\
+	field("source",			KV_TYPE_STRING)	\
+	field("instance",		KV_TYPE_INT)	\
+	field("reason",			KV_TYPE_STRING)	\
+	field("slot",			KV_TYPE_STRING)	\
+	field("status",			KV_TYPE_STRING)	\
+	field("event_type",		KV_TYPE_STRING)	\
+	field("event_complement",	KV_TYPE_INT)
+
 extern int elog_print_type(struct platform_intf *intf,
                            struct smbios_log_entry *entry, struct kv_pair *kv);
 extern int elog_print_data(struct platform_intf *intf,
@@ -61,6 +85,9 @@ extern int elog_verify(struct platform_intf *intf,
 extern int elog_verify_header(struct elog_header *elog_header);
 extern int elog_print_multi(struct platform_intf *intf,
                             struct smbios_log_entry *entry, int start_id);
+/* number of records elog_print_multi() prints, without decoding the rest */
+extern int elog_count_multi(struct platform_intf *intf,
+			    struct smbios_log_entry *entry);
 extern int elog_add_event_manually(struct platform_intf *intf,
 				   enum smbios_log_entry_type type,
 				   size_t data_size, uint8_t *data);
@@ -97,6 +97,129 @@ extern void smbios_eventlog_print_timestamp(struct platform_intf *intf,
 extern int smbios_eventlog_event_time(struct smbios_log_entry *entry,
 				      time_t *time);
 
+/*
+ * smbios_eventlog_time_key - get a key ordering eventlog entries by time
+ *
+ * @entry - smbios event
+ *
+ * Keys compare as the timestamps of the entries do.  They are made of the
+ * BCD fields as they are, so entries can be filtered by time without
+ * decoding their timestamps.  Years 69 to 99 are before year 00, as for
+ * smbios_eventlog_event_time().
+ */
+static inline uint64_t smbios_eventlog_time_key(
+	const struct smbios_log_entry *entry)
+{
+	uint64_t year = entry->year >= 0x69 ? entry->year - 0x69
+					    : entry->year + 0x100;
+
+	return year << 40 | (uint64_t)entry->month << 32 |
+	       (uint64_t)entry->day << 24 | (uint64_t)entry->hour << 16 |
+	       (uint64_t)entry->minute << 8 | entry->second;
+}
+
+/*
+ * smbios_eventlog_time_key_parse - get the time key of a printed timestamp
+ *
+ * @str - "YYYY-MM-DD", "YYYY-MM-DD HH:MM" or "YYYY-MM-DD HH:MM:SS", in
+ *        local time as smbios_eventlog_print_timestamp() prints it
+ * @key - filled in with the key of an entry logged at that time
+ *
+ * Times before or after the years the log can hold give the lowest or the
+ * highest key.
+ *
+ * returns 0 on success, < 0 with errno set to EINVAL if @str is not a
+ * timestamp
+ */
+extern int smbios_eventlog_time_key_parse(const char *str, uint64_t *key);
+
+/*
+ * An eventlog fetched once from the platform, so that it can be read and
+ * rewritten without fetching it again.  The data and iterator are
+ * allocated from the command arena, see mosys_cmd_arena().
+ */
+struct smbios_eventlog_snapshot {
+	uint8_t *data;		/* the whole log area */
+	size_t length;
+	off_t header_offset;
+	off_t data_offset;	/* of the first event */
+	struct smbios_eventlog_iterator *iter;
+
+	/* see smbios_eventlog_snapshot_index() */
+	uint32_t *offsets;	/* of each entry, then of the end of the last */
+	int entries;
+	int corrupt;		/* entries end at a zero-length one */
+};
+
+/*
+ * smbios_eventlog_snapshot_fetch - fetch the eventlog of the platform
+ *
+ * @intf - platform interface
+ * @elog - snapshot to fill in
+ *
+ * returns 0 on success
+ * returns < 0 on failure, with errno set to ENOSYS if the platform cannot
+ * fetch its eventlog
+ */
+extern int smbios_eventlog_snapshot_fetch(struct platform_intf *intf,
+					  struct smbios_eventlog_snapshot *elog);
+
+/*
+ * smbios_eventlog_snapshot_index - index the entries of a fetched eventlog
+ *
+ * @elog - snapshot from smbios_eventlog_snapshot_fetch()
+ *
+ * Validates the entries in one pass and records their offsets, so that
+ * entry i is at elog->data + elog->offsets[i] and the first i entries
+ * take elog->offsets[i] - elog->data_offset bytes.  Entries following a
+ * zero-length one cannot be reached and are left out.
+ *
+ * returns 0 on success
+ * returns < 0 if a zero-length entry was found, the entries before it are
+ * indexed anyway
+ */
+extern int smbios_eventlog_snapshot_index(struct smbios_eventlog_snapshot *elog);
+
+/*
+ * smbios_eventlog_snapshot_entry - get an indexed eventlog entry
+ *
+ * @elog - snapshot indexed by smbios_eventlog_snapshot_index()
+ * @i - entry number, from 0 to elog->entries - 1
+ */
+static inline struct smbios_log_entry *smbios_eventlog_snapshot_entry(
+	const struct smbios_eventlog_snapshot *elog, int i)
+{
+	return (struct smbios_log_entry *)&elog->data[elog->offsets[i]];
+}
+
+/*
+ * smbios_eventlog_entry_hash - hash an eventlog entry
+ *
+ * @entry - smbios event, including its data
+ *
+ * returns a 32-bit FNV-1a hash of the entry, to recognize it in a later
+ * fetch of the log
+ */
+extern uint32_t smbios_eventlog_entry_hash(
+	const struct smbios_log_entry *entry);
+
+/*
+ * smbios_eventlog_snapshot_foreach - call callback for each event of a
+ *                                    fetched eventlog
+ *
+ * @intf - platform interface
+ * @elog - snapshot from smbios_eventlog_snapshot_fetch()
+ * @verify - optional function to call to verify the eventlog metadata
+ * @callback - function to call for each log entry
+ * @arg - optional argument to pass to callback
+ *
+ * returns the aggregation (OR) of return codes for each call to callback.
+ */
+extern int smbios_eventlog_snapshot_foreach(
+	struct platform_intf *intf, struct smbios_eventlog_snapshot *elog,
+	smbios_eventlog_verify_header verify,
+	smbios_eventlog_callback callback, void *arg);
+
 /*
  * smbios_eventlog_foreach_event - call callback for each event in the SMBIOS
  *                                 eventlog.
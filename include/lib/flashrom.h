@@ -32,6 +32,9 @@
 #ifndef MOSYS_LIB_FLASHROM_H__
 #define MOSYS_LIB_FLASHROM_H__
 
+struct mosys_arena;
+struct platform_intf;
+
 /*
  * flashrom_read - Read ROM using Flashrom utility
  *
@@ -48,6 +51,7 @@ extern int flashrom_read(uint8_t *buf, size_t size, const char *region);
 /*
  * flashrom_read_by_name - Partial read using Flashrom utility
  *
+ * @arena:	arena to allocate buf from
  * @buf:	double-pointer of buffer to allocate and fill
  * @region:	region to include with -i
  *
@@ -57,7 +61,8 @@ extern int flashrom_read(uint8_t *buf, size_t size, const char *region);
  * returns number of bytes read from region to indicate success
  * returns <0 to indicate failure
  */
-extern int flashrom_read_by_name(uint8_t **buf, const char *region);
+extern int flashrom_read_by_name(struct mosys_arena *arena, uint8_t **buf,
+				 const char *region);
 
 /*
  * flashrom_write_by_name - Partial write using Flashrom utility
@@ -77,6 +82,7 @@ extern int flashrom_write_by_name(size_t size, uint8_t *buf, const char *region)
 /*
  * flashrom_read_host_firmware_region - Read firmware region within ROM
  *
+ * @arena:	arena to allocate buf from
  * @buf:	double-pointer of buffer to allocate and fill
  *
  * This assumes that the name of the firmware region corresponds to a defined
@@ -86,6 +92,7 @@ extern int flashrom_write_by_name(size_t size, uint8_t *buf, const char *region)
  * returns <0 to indicate failure
  */
 extern int flashrom_read_host_firmware_region(struct platform_intf *intf,
-							uint8_t **buf);
+					      struct mosys_arena *arena,
+					      uint8_t **buf);
 
 #endif /* MOSYS_LIB_FLASHROM_H__ */
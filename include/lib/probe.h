@@ -34,6 +34,19 @@
 
 struct platform_intf;
 
+/**
+ * get_frid(buf, buf_sz) - get the firmware revision ID
+ *
+ * @buf:        The buffer to write the FRID into.
+ * @buf_sz:     The size of @buf.
+ *
+ * The FRID is read from ACPI on x86 and from the device tree on ARM,
+ * e.g. "Google_Samus.6300.102.0".
+ *
+ * Return: The length of the FRID on success, -1 otherwise.
+ */
+ssize_t get_frid(char *buf, size_t buf_sz);
+
 /**
  * get_firmware_name(buf, buf_sz) - get the firmware name
  *
@@ -49,6 +62,17 @@ struct platform_intf;
  */
 ssize_t get_firmware_name(char *buf, size_t buf_sz);
 
+/**
+ * probe_get_firmware_name() - get the firmware name, read only once
+ *
+ * Same as get_firmware_name(), but the name is read on the first call
+ * only, and shared by all callers.  This is safe to call from several
+ * threads at once.
+ *
+ * Return: The firmware name on success, NULL otherwise.
+ */
+extern const char *probe_get_firmware_name(void);
+
 /*
  * probe_frid - attempt to match platform to chromeos firmware revision id
  *
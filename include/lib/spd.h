@@ -180,7 +180,17 @@ extern struct spd_device *new_spd_device(struct platform_intf *intf, int dimm);
 extern int spd_print_reg(struct platform_intf *intf,
 			 struct kv_pair *kv, const void *data, uint8_t reg);
 
-/* add field to key=value pair */
+/*
+ * spd_field_wanted  -  check whether a field will be printed
+ *
+ * @type:	type of field
+ *
+ * returns 1 if the key of the field is printed (see kv_key_wanted())
+ * returns 0 if the field can be skipped
+ */
+extern int spd_field_wanted(enum spd_field_type type);
+
+/* add field to key=value pair, unless the -s option filters it out */
 extern int spd_print_field(struct platform_intf *intf,
 			   struct kv_pair *kv,
 			   const void *data, enum spd_field_type type);
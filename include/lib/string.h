@@ -39,6 +39,18 @@
 #include <inttypes.h>
 #include <stddef.h>
 
+/*
+ * write the lowercase hexadecimal digits of an array of bytes, two per
+ * byte, without a terminating NUL
+ *
+ * dst:      output, at least 2 * length bytes
+ * src:      pointer to byte array
+ * length:   size of byte array
+ *
+ * returns a pointer past the last digit written
+ */
+extern char *hex_encode(char *dst, const uint8_t *src, size_t length);
+
 /*
  * convert an array of bytes to a hexadecimal string (no prefix)
  *
@@ -87,6 +87,45 @@ internal_mosys_strdup(const char *str,
 #define mosys_strdup(str) \
 	internal_mosys_strdup((str), __FILE__, __LINE__, __func__)
 
+/*
+ * Arenas hand out memory which is all released at once, e.g. at the end of
+ * a command, rather than freed piece by piece.  Small allocations are
+ * carved out of 64KiB chunks; large ones, such as flash images, get a
+ * block of their own, mapped with mmap() past ARENA_MMAP_THRESHOLD bytes.
+ * An arena must only be used by one thread at a time.
+ */
+#define ARENA_MMAP_THRESHOLD	(256 * 1024)
+
+struct mosys_arena;
+
+/* memory used through an arena */
+struct mosys_arena_stats {
+	size_t bytes;			/* allocated since the last release */
+	size_t peak_bytes;		/* most bytes, since the last release */
+	size_t total_bytes;		/* allocated since the arena was created */
+	size_t allocations;		/* since the arena was created */
+};
+
+/* create an arena, free with mosys_arena_free() */
+extern struct mosys_arena *mosys_arena_new(void);
+/* release the memory of an arena and free it, does nothing if NULL */
+extern void mosys_arena_free(struct mosys_arena *arena);
+/*
+ * release all memory allocated from an arena, keeping a chunk for further
+ * allocations, does nothing if NULL
+ */
+extern void mosys_arena_release(struct mosys_arena *arena);
+/* get the usage statistics of an arena, all zero if NULL */
+extern void mosys_arena_stats(const struct mosys_arena *arena,
+			      struct mosys_arena_stats *stats);
+
+/* allocate memory from an arena, suitably aligned for any type */
+extern void *
+internal_mosys_arena_alloc(struct mosys_arena *arena, size_t size,
+                          const char *file, int line, const char *func);
+#define mosys_arena_alloc(arena, size) \
+	internal_mosys_arena_alloc((arena), (size), __FILE__, __LINE__, __func__)
+
 /* The allocation failure handler funtion signature */
 typedef int (*alloc_failure_handler)(size_t size, const char *file, int line,
                                      const char *func);
@@ -3,7 +3,21 @@
  * found in the LICENSE file.
  */
 
+struct platform_intf;
+
 /**
  * The mosys main function.
  */
 int mosys_main(int argc, char **argv);
+
+/**
+ * mosys_run_cmd() - run one command against an already setup platform
+ *
+ * @intf:       Platform interface.
+ * @argc:       Number of command words.
+ * @argv:       Command words, e.g. { "ec", "info" }.
+ *
+ * Return: the process exit status the command would have had if it
+ * had been run on its own.
+ */
+int mosys_run_cmd(struct platform_intf *intf, int argc, char **argv);
@@ -42,5 +42,6 @@ extern struct platform_cmd cmd_ec;
 extern struct platform_cmd cmd_pd;
 extern struct platform_cmd cmd_fp;
 extern struct platform_cmd cmd_psu;
+extern struct platform_cmd cmd_snapshot;
 
 #endif /* MOSYS_COMMAND_LIST_H__ */
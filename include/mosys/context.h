@@ -0,0 +1,143 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * context.h: per-invocation state
+ *
+ * Everything which used to be a process global and can differ between
+ * two queries (log and output settings, I/O counters, open devices and
+ * data cached from them) lives in a struct mosys_ctx.  Each thread runs
+ * against its current context, which is the process-wide default one
+ * unless mosys_ctx_set() was called.
+ *
+ * Values which cannot change before the next boot, such as those read
+ * by the platform probes, are still shared by all contexts, and so are
+ * the platform interfaces and the EC devices they open.  Commands with
+ * their own contexts may therefore only run in parallel threads if they
+ * do not use the same EC (as "snapshot" arranges) and do not set up the
+ * platform; otherwise they must be serialized (as libmosys does).
+ */
+
+#ifndef MOSYS_CONTEXT_H__
+#define MOSYS_CONTEXT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "mosys/counters.h"
+#include "mosys/kv_pair.h"
+#include "mosys/log.h"
+
+#define I2C_HANDLE_MAX		64
+
+struct log_ring;
+struct mosys_arena;
+struct spd_device;
+
+struct mosys_ctx {
+	/* logging, see log.c */
+	const char *log_name;
+	enum log_levels log_threshold;
+	FILE *log_outfile;
+	int log_valid;
+	char *log_buf;			/* messages not written out yet */
+	size_t log_len;
+	enum log_levels log_flush_level;	/* written out right away */
+	struct log_ring *log_ring;	/* recent messages not printed */
+
+	/* output, see globals.c and kv_pair.c */
+	FILE *output_file;		/* NULL for stdout */
+	int verbosity;
+	enum kv_pair_style kv_style;
+	const char *kv_single_key;
+	kv_pair_sink kv_sink;
+	void *kv_sink_arg;
+	int kv_sink_stopped;		/* sink wants no more records */
+	const struct kv_schema *kv_schema;	/* of the command running */
+	int kv_in_list;			/* printing a JSON or CBOR array */
+	int kv_list_records;		/* records printed in the array */
+	char *out_buf;			/* buffered output, see output.c */
+	size_t out_len;
+
+	/* behavior, see globals.c */
+	int keep_devices_open;
+	int use_platform_cache;
+
+	/* memory released with the context, and after each command */
+	struct mosys_arena *arena;
+	struct mosys_arena *cmd_arena;
+
+	/* I/O accounting, see counters.h */
+	uint64_t counters[COUNTER_MAX];
+
+	/* open I2C devices, see intf/i2c.c */
+	struct mosys_i2c_handle {
+		int bus;
+		int addr;
+		int fd;
+	} i2c_handles[I2C_HANDLE_MAX];
+	int i2c_handle_num;
+	int i2c_no_word_reads;		/* adapter only supports byte reads */
+
+	/* host firmware image read for SPD in CBFS, see lib/spd/spd.c */
+	uint8_t *fw_buf;		/* from arena */
+	int fw_size;			/* <0 if reading it failed */
+
+	/* SPD of each DIMM, see lib/spd/spd.c */
+	struct spd_device **spd_devices;	/* NULL if not read yet */
+	int spd_device_num;
+};
+
+/*
+ * mosys_ctx_get  -  get the context of the calling thread
+ *
+ * returns the context set by mosys_ctx_set(), or the default context
+ */
+extern struct mosys_ctx *mosys_ctx_get(void);
+
+/*
+ * mosys_ctx_set  -  set the context of the calling thread
+ *
+ * @ctx:	context to use, NULL for the default context
+ *
+ * returns the context which was used before
+ */
+extern struct mosys_ctx *mosys_ctx_set(struct mosys_ctx *ctx);
+
+/*
+ * mosys_ctx_new  -  create a context
+ *
+ * The new context starts with the log and output settings of the
+ * calling thread's context, and with no counters, devices or caches.
+ *
+ * returns the new context, free with mosys_ctx_free()
+ */
+extern struct mosys_ctx *mosys_ctx_new(void);
+
+/*
+ * mosys_ctx_free  -  write out pending output, close the devices of a
+ *                   context and free it
+ *
+ * @ctx:	context from mosys_ctx_new(), must not be current in any
+ *		thread
+ */
+extern void mosys_ctx_free(struct mosys_ctx *ctx);
+
+/*
+ * mosys_ctx_arena  -  get the arena of the current context
+ *
+ * Memory allocated from it is released when the context is freed, so it
+ * suits data cached for the lifetime of a context.
+ */
+extern struct mosys_arena *mosys_ctx_arena(void);
+
+/*
+ * mosys_cmd_arena  -  get the command arena of the current context
+ *
+ * Memory allocated from it is released when the running command is done
+ * (see mosys_run_cmd()), or when the context is freed.
+ */
+extern struct mosys_arena *mosys_cmd_arena(void);
+
+#endif /* MOSYS_CONTEXT_H__ */
@@ -0,0 +1,60 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * counters.h: I/O accounting counters
+ */
+
+#ifndef MOSYS_COUNTERS_H__
+#define MOSYS_COUNTERS_H__
+
+#include <stdint.h>
+
+enum mosys_counter {
+	COUNTER_FILES_OPENED = 0,	/* file_open(), read_file() */
+	COUNTER_BYTES_READ,		/* bytes returned by read_file() */
+	COUNTER_MMIO_MAPS,		/* mmio_mmap() */
+	COUNTER_I2C_OPS,		/* calls into i2c_dev_intf ops */
+	COUNTER_EC_COMMANDS,		/* commands sent to the EC driver */
+	COUNTER_CHILD_PROCS,		/* child processes forked */
+	COUNTER_MAX,
+};
+
+/*
+ * mosys_ctx_counters  -  get the counters of the current context
+ *
+ * Do not access directly, use counter_add().
+ */
+extern uint64_t *mosys_ctx_counters(void);
+
+/*
+ * counter_add  -  account for I/O
+ *
+ * @counter:	counter to increase
+ * @n:		amount to increase it by
+ */
+static inline void counter_add(enum mosys_counter counter, uint64_t n)
+{
+	/* atomic, since platforms may be probed from several threads */
+	__atomic_fetch_add(&mosys_ctx_counters()[counter], n,
+			   __ATOMIC_RELAXED);
+}
+
+/* zero all counters of the current context */
+extern void counters_reset(void);
+
+/*
+ * counters_report  -  print counters accumulated since the last reset
+ *
+ * @label:	what the counters were accumulated for, e.g. a command line
+ * @machine:	non-zero to always print a machine-readable line, otherwise
+ *		the counters are only logged at LOG_NOTICE (-vv) and above
+ *
+ * The machine-readable form is one line of key="value" pairs written to
+ * the log output, such as:
+ *
+ *   counters="platform name" files_opened="2" bytes_read="24" ...
+ */
+extern void counters_report(const char *label, int machine);
+
+#endif /* MOSYS_COUNTERS_H__ */
@@ -0,0 +1,52 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * daemon.h: serve mosys commands over a Unix socket
+ */
+
+#ifndef MOSYS_DAEMON_H__
+#define MOSYS_DAEMON_H__
+
+struct platform_intf;
+
+/* Environment variable naming the daemon socket used by the client shim */
+#define MOSYSD_SOCKET_ENV	"MOSYSD_SOCKET"
+
+/* Largest request accepted by the daemon, in bytes */
+#define MOSYSD_MAX_REQUEST	4096
+
+/*
+ * mosys_daemon_serve  -  answer command requests until told to stop
+ *
+ * @intf:	platform interface, already set up
+ * @path:	filesystem path of the Unix socket to listen on
+ *
+ * Requests are served one at a time against @intf, which is kept set
+ * up (along with any open EC devices) for the lifetime of the daemon.
+ * Results of commands marked with CMD_FLAG_BOOT_CONSTANT are cached.
+ * The socket is created with mode 0600, and only root and the user
+ * running the daemon are served.
+ * SIGTERM and SIGINT make the daemon remove its socket and return.
+ *
+ * returns 0 on clean shutdown
+ * returns <0 to indicate failure
+ */
+extern int mosys_daemon_serve(struct platform_intf *intf, const char *path);
+
+/*
+ * mosys_daemon_request  -  run a command line through a running daemon
+ *
+ * @path:	filesystem path of the daemon socket
+ * @argc:	argument count, as passed to main()
+ * @argv:	argument vector, as passed to main()
+ *
+ * The command output and log messages are copied to stdout and stderr.
+ *
+ * returns the exit status of the command
+ * returns <0 if the daemon is unreachable or cannot handle the request,
+ *         in which case the caller should run the command itself
+ */
+extern int mosys_daemon_request(const char *path, int argc, char **argv);
+
+#endif /* MOSYS_DAEMON_H__ */
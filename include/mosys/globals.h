@@ -52,6 +52,18 @@ extern void mosys_set_output_file(FILE *fp);
 extern int mosys_get_verbosity(void);
 extern void mosys_set_verbosity(int verbosity);
 
+/*
+ * manage whether devices (e.g. the EC) stay open between commands
+ */
+extern int mosys_get_keep_devices_open(void);
+extern void mosys_set_keep_devices_open(int keep);
+
+/*
+ * manage whether platform probing results are cached for the boot
+ */
+extern int mosys_get_use_platform_cache(void);
+extern void mosys_set_use_platform_cache(int use);
+
 #include <limits.h>
 
 #endif /* MOSYS_GLOBALS_H__ */
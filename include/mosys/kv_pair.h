@@ -35,49 +35,101 @@
 
 #include <stdio.h>
 #include <inttypes.h>
+#include <stdint.h>
 #include <string.h>
 
-/* key=value string pair list */
-#define KV_PAIR_MAX_VALUE_LEN      1024
+/*
+ * Functions of the libmosys API.  The library is built with hidden
+ * visibility, so everything else stays internal to it.
+ */
+#define MOSYS_API	__attribute__((visibility("default")))
 
 enum kv_pair_style {
 	KV_STYLE_PAIR,		/* key1="value1" key2="value2" */
 	KV_STYLE_VALUE,		/* | value1 | value2 | */
 	KV_STYLE_LONG,		/* key1         | value1 */
 				/* key2         | value2 */
-	KV_STYLE_SINGLE,	/* prints raw value for specified key */
+	KV_STYLE_SINGLE,	/* prints raw values for specified keys */
+	KV_STYLE_JSON,		/* {"key1":"value1","key2":"value2"} */
+	KV_STYLE_CBOR,		/* binary, see kv_pair_output_begin() */
+};
+
+/* type of a value, kept by binary output */
+enum kv_type {
+	KV_TYPE_STRING,
+	KV_TYPE_INT,
+	KV_TYPE_BOOL,
 };
 
-struct kv_pair {
-	char *key;
-	char *value;
-	struct kv_pair *next;
+/*
+ * Schema of the records a command prints: every key it may print, with
+ * the type of its value, terminated by an entry with a NULL key.  Keys
+ * must only ever be added at the end, as binary output refers to them
+ * by position.
+ */
+struct kv_schema {
+	const char *key;
+	enum kv_type type;
 };
 
+/*
+ * A record of key=value string pairs, in the order they were added.
+ * Values are copied into the record.  Keys are kept by reference, as
+ * they are nearly always string literals, unless added with
+ * KV_PAIR_COPY_KEY.
+ */
+struct kv_pair;
+
+/* flags for kv_pair_add_flags() */
+#define KV_PAIR_COPY_KEY	(1 << 0)	/* key is not a literal */
+
 extern enum kv_pair_style mosys_get_kv_pair_style(void);
 
 extern void mosys_set_kv_pair_style(enum kv_pair_style style);
 
 /*
- * kv_get_single_key  -  get single key to match against if -s option used
+ * kv_get_single_key  -  get keys to match against if -s option used
  *
- * returns single value specified by user
- * returns NULL if no single value has been specified by the user
+ * returns comma-separated list of keys specified by user
+ * returns NULL if no keys have been specified by the user
  */
 extern const char *kv_get_single_key(void);
 
 /*
- * kv_set_single_key  -  set single key to match when using -s option
+ * kv_set_single_key  -  set keys to match when using -s option
  *
- * @value:	value to match against
+ * @value:	comma-separated list of keys to match against, e.g.
+ *		"size_mb,speeds"
  */
 extern void kv_set_single_key(const char *value);
 
+/*
+ * kv_key_wanted  -  check whether a key will be printed
+ *
+ * @key:	key to check
+ *
+ * Commands can use this to skip computing fields, and the I/O needed
+ * for them, which the -s option would filter out anyway.
+ *
+ * returns 1 if @key is printed, or if all keys are
+ * returns 0 if @key is filtered out
+ */
+extern int kv_key_wanted(const char *key);
+
+/*
+ * kv_any_key_wanted  -  check whether any of a set of keys will be printed
+ *
+ * @keys:	NULL-terminated list of keys to check
+ *
+ * returns 1 if any of @keys is printed
+ * returns 0 if all of @keys are filtered out
+ */
+extern int kv_any_key_wanted(const char *const *keys);
+
 /*
  * kv_pair_new  -  create new key=value pair
  *
  * returns pointer to new key=value pair
- * returns NULL to indicate error
  */
 extern struct kv_pair *kv_pair_new(void);
 
@@ -85,15 +137,28 @@ extern struct kv_pair *kv_pair_new(void);
  * kv_pair_add  -  add new key=value pair to list
  *
  * @kv_list:    key=value pair list
- * @key:        key string
- * @value:      value string
+ * @key:        key string, must outlive @kv_list
+ * @value:      value string, nothing is added if NULL
  *
- * returns pointer to new key=value pair
- * returns NULL to indicate error
+ * returns @kv_list
  */
 extern struct kv_pair *kv_pair_add(struct kv_pair *kv_list,
                                    const char *key, const char *value);
 
+/*
+ * kv_pair_add_flags  -  add new key=value pair to list
+ *
+ * @kv_list:    key=value pair list
+ * @key:        key string
+ * @value:      value string, nothing is added if NULL
+ * @flags:      KV_PAIR_COPY_KEY to copy @key rather than refer to it
+ *
+ * returns @kv_list
+ */
+extern struct kv_pair *kv_pair_add_flags(struct kv_pair *kv_list,
+                                         const char *key, const char *value,
+                                         unsigned int flags);
+
 /*
  * kv_pair_add_bool  -  add new boolean kvpair to list
  *
@@ -101,8 +166,7 @@ extern struct kv_pair *kv_pair_add(struct kv_pair *kv_list,
  * @key:        key string
  * @value:      value
  *
- * returns pointer to new key=value pair
- * returns NULL to indicate error
+ * returns @kv_list
  */
 extern struct kv_pair *kv_pair_add_bool(struct kv_pair *kv_list,
                                         const char *key, int value);
@@ -112,22 +176,104 @@ extern struct kv_pair *kv_pair_add_bool(struct kv_pair *kv_list,
  *                 NOTE: uses variable argument list
  *
  * @kv_list:    list of key=value pairs
- * @kv_key:     key string
+ * @kv_key:     key string, must outlive @kv_list
  * @format:     printf-style format for value input
  * @...:        arguments to format
  *
- * returns pointer to new key=value pair
- * returns NULL to indicate error
+ * returns @kv_list
  */
 extern struct kv_pair *kv_pair_fmt(struct kv_pair *kv_list,
-                                   const char *kv_key, const char *format, ...);
+                                   const char *kv_key, const char *format, ...)
+	__attribute__((format(printf, 3, 4)));
+
+/*
+ * kv_pair_add_int  -  add integer key=value pair to list
+ *
+ * @kv_list:    list of key=value pairs
+ * @key:        key string, must outlive @kv_list
+ * @num:        value
+ *
+ * returns @kv_list
+ */
+extern struct kv_pair *kv_pair_add_int(struct kv_pair *kv_list,
+                                       const char *key, int64_t num);
+
+/*
+ * kv_pair_fmt_int  -  add integer key=value pair with printf formatted text
+ *
+ * @kv_list:    list of key=value pairs
+ * @kv_key:     key string, must outlive @kv_list
+ * @num:        value, as printed in binary output
+ * @format:     printf-style format for the value in text output, e.g. to
+ *              print it in hex or a timestamp as a date
+ * @...:        arguments to format
+ *
+ * returns @kv_list
+ */
+extern struct kv_pair *kv_pair_fmt_int(struct kv_pair *kv_list,
+                                       const char *kv_key, int64_t num,
+                                       const char *format, ...)
+	__attribute__((format(printf, 4, 5)));
+
+/*
+ * kv_pair_append  -  add all pairs of a list to another
+ *
+ * @kv_list:    key=value pair list to add to
+ * @src:        key=value pair list to copy, keys copied into @src are
+ *              copied again
+ *
+ * returns @kv_list
+ */
+extern struct kv_pair *kv_pair_append(struct kv_pair *kv_list,
+                                      const struct kv_pair *src);
+
+/*
+ * kv_pair_count  -  get the number of pairs in a list
+ *
+ * @kv_list:    key=value pair list, may be NULL
+ */
+extern MOSYS_API int kv_pair_count(const struct kv_pair *kv_list);
+
+/*
+ * kv_pair_key, kv_pair_value  -  get a pair of a list
+ *
+ * @kv_list:    key=value pair list
+ * @i:          pair number, from 0 to kv_pair_count() - 1
+ */
+extern MOSYS_API const char *kv_pair_key(const struct kv_pair *kv_list, int i);
+extern MOSYS_API const char *kv_pair_value(const struct kv_pair *kv_list,
+					   int i);
+
+/*
+ * kv_pair_type, kv_pair_int  -  get the type and integer value of a pair
+ *
+ * @kv_list:    key=value pair list
+ * @i:          pair number, from 0 to kv_pair_count() - 1
+ *
+ * kv_pair_int() returns 0 for string values, and 0 or 1 for booleans.
+ */
+extern MOSYS_API enum kv_type kv_pair_type(const struct kv_pair *kv_list,
+					   int i);
+extern MOSYS_API int64_t kv_pair_int(const struct kv_pair *kv_list, int i);
+
+/*
+ * kv_pair_get  -  look up the value of a key
+ *
+ * @kv_list:    key=value pair list
+ * @key:        key to look for
+ *
+ * returns the value of the first pair with @key
+ * returns NULL if there is none
+ */
+extern MOSYS_API const char *kv_pair_get(const struct kv_pair *kv_list,
+					 const char *key);
 
 /*
  * kv_pair_free  -  clean a key=value pair list
  *
  * @kv_list:    pointer to key=value list
  */
-extern void kv_pair_free(struct kv_pair *kv_list);
+extern MOSYS_API void kv_pair_free(struct kv_pair *kv_list);
 
 /*
  * kv_pair_print  -  print a key=value pair list
@@ -151,4 +297,61 @@ extern int kv_pair_print_to_file(FILE* fp, struct kv_pair *kv_list,
  */
 extern int kv_pair_print(struct kv_pair *kv_list);
 
+/*
+ * kv_pair_output_begin, kv_pair_output_end  -  mark the output of a command
+ *
+ * @schema:     records the command prints, NULL if it has no schema
+ * @list:       non-zero if the command prints a list of records (one per
+ *              DIMM, eventlog entry, ...)
+ *
+ * Commands are run between these so that their output is one document:
+ *
+ * - In JSON, a list of records is a single array even if it has one
+ *   record or none.
+ * - In CBOR, the output is a two element array: the schema, as an array of
+ *   [key, type] arrays (type being "string", "int" or "bool"), and an
+ *   indefinite length array of records.  Records are maps, keyed by the
+ *   position of the key in the schema, or by the key itself if the schema
+ *   does not have it.
+ *
+ * Nothing is printed in other styles.
+ */
+extern void kv_pair_output_begin(const struct kv_schema *schema, int list);
+extern void kv_pair_output_end(void);
+
+/*
+ * kv_pair_sink  -  callback receiving records instead of the output file
+ *
+ * @kv_list:    key=value list being printed, freed by the caller after
+ *              the sink returns
+ * @arg:        argument given to kv_pair_set_sink()
+ *
+ * returns 0 to indicate success
+ * returns KV_SINK_STOP if no more records are wanted
+ * returns <0 to indicate failure
+ */
+typedef int (*kv_pair_sink)(struct kv_pair *kv_list, void *arg);
+
+#define KV_SINK_STOP	1
+
+/*
+ * kv_pair_set_sink  -  route kv_pair_print() to a callback
+ *
+ * @sink:       callback to hand every printed list to, NULL to print to
+ *              mosys output again
+ * @arg:        argument to pass to @sink
+ */
+extern void kv_pair_set_sink(kv_pair_sink sink, void *arg);
+
+/*
+ * kv_pair_print_stopped  -  check whether the sink wants more records
+ *
+ * Once the sink returned KV_SINK_STOP, kv_pair_print() drops every
+ * record until the next kv_pair_set_sink().  Commands printing many
+ * records can check this to stop producing them early.
+ *
+ * returns 1 if no more records are wanted, 0 otherwise
+ */
+extern int kv_pair_print_stopped(void);
+
 #endif /* KV_PAIR_H__ */
@@ -0,0 +1,194 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * libmosys.h: structured, non-printing API for embedding mosys
+ *
+ * Results are returned as key=value lists (struct kv_pair), the same
+ * records the mosys commands print, so the keys are those of
+ * "mosys -k <command>", and can be read with kv_pair_count(),
+ * kv_pair_key() and kv_pair_value().  The library keeps the platform it
+ * detected, and any caches, for as long as the handle is open.
+ *
+ * Each handle keeps its own log and output settings, I/O counters, I2C
+ * devices and SPD data.  The EC devices and the platform interfaces are
+ * shared by the whole process, though, so the library serializes calls:
+ * handles may be used from any thread, but only one call runs at a time.
+ * Callbacks must not call back into the library.
+ */
+
+#ifndef MOSYS_LIBMOSYS_H__
+#define MOSYS_LIBMOSYS_H__
+
+#include "mosys/kv_pair.h"
+
+struct mosys_handle;
+
+/* A list of records, e.g. one per DIMM or eventlog entry */
+struct mosys_records {
+	struct kv_pair **records;
+	int count;
+};
+
+struct mosys_platform_info {
+	const char *name;		/* canonical platform name */
+	char *vendor;			/* NULL if unknown, as all below */
+	char *version;
+	char *model;
+	char *chassis;
+	char *brand;
+	char *customization;
+	int sku_number;			/* <0 if unknown */
+};
+
+enum mosys_ec_type {
+	MOSYS_EC_MAIN,			/* "ec info" */
+	MOSYS_EC_PD,			/* "pd info" */
+	MOSYS_EC_FP,			/* "fp info" */
+};
+
+struct mosys_ec_info {
+	char vendor[32];		/* empty if unknown, as all below */
+	char name[32];
+	char fw_version[32];
+};
+
+/*
+ * mosys_eventlog_fn  -  called for each eventlog entry
+ *
+ * @entry:	entry fields ("entry", "timestamp", "type", ...), only
+ *		valid until the callback returns
+ * @arg:	argument given to mosys_eventlog_foreach()
+ *
+ * returns 0 to continue, non-zero to skip the remaining entries
+ */
+typedef int (*mosys_eventlog_fn)(const struct kv_pair *entry, void *arg);
+
+/*
+ * mosys_open  -  identify the platform and set it up
+ *
+ * @platform_name:	platform to use, or NULL to detect it
+ *
+ * returns a handle for the other functions
+ * returns NULL if the platform is not supported
+ */
+extern MOSYS_API struct mosys_handle *mosys_open(const char *platform_name);
+
+/*
+ * mosys_close  -  clean up the platform and free the handle
+ *
+ * @h:		handle from mosys_open()
+ */
+extern MOSYS_API void mosys_close(struct mosys_handle *h);
+
+/*
+ * mosys_query  -  run a command and collect the records it returns
+ *
+ * @h:		handle from mosys_open()
+ * @argc:	number of command words
+ * @argv:	command words, e.g. { "memory", "spd", "print", "id" }
+ * @res:	filled with the records, free with mosys_records_free()
+ *
+ * Nothing is printed to stdout.  Errors are logged at LOG_ERR to
+ * stderr as they would be by the mosys command.
+ *
+ * returns 0 to indicate success
+ * returns -1 and sets errno to indicate failure
+ */
+extern MOSYS_API int mosys_query(struct mosys_handle *h, int argc, char **argv,
+				 struct mosys_records *res);
+
+/*
+ * mosys_records_free  -  free records returned by the library
+ *
+ * @res:	records to free
+ */
+extern MOSYS_API void mosys_records_free(struct mosys_records *res);
+
+/*
+ * mosys_record_get  -  look up a field in a record
+ *
+ * @record:	key=value list
+ * @key:	key to look for
+ *
+ * returns the value, or NULL if @record has no such key
+ */
+extern MOSYS_API const char *mosys_record_get(const struct kv_pair *record,
+					      const char *key);
+
+/*
+ * mosys_get_platform_info  -  get the platform identity and SKU information
+ *
+ * @h:		handle from mosys_open()
+ * @info:	filled with the information, free with
+ *		mosys_platform_info_free()
+ *
+ * returns 0 to indicate success
+ * returns -1 and sets errno to indicate failure
+ */
+extern MOSYS_API int mosys_get_platform_info(struct mosys_handle *h,
+					     struct mosys_platform_info *info);
+
+/*
+ * mosys_platform_info_free  -  free strings in platform information
+ *
+ * @info:	information from mosys_get_platform_info()
+ */
+extern MOSYS_API void
+mosys_platform_info_free(struct mosys_platform_info *info);
+
+/*
+ * mosys_get_dimm_count  -  get the number of DIMM slots
+ *
+ * @h:		handle from mosys_open()
+ *
+ * returns the number of DIMM slots
+ * returns -1 and sets errno to indicate failure
+ */
+extern MOSYS_API int mosys_get_dimm_count(struct mosys_handle *h);
+
+/*
+ * mosys_get_dimm_info  -  get the SPD fields of a DIMM
+ *
+ * @h:		handle from mosys_open()
+ * @dimm:	DIMM number, from 0 to mosys_get_dimm_count() - 1
+ * @fields:	filled with the type, ID, geometry and timing fields of
+ *		"memory spd print all", free with kv_pair_free()
+ *
+ * returns 0 to indicate success
+ * returns -1 and sets errno to indicate failure (ENODEV if the slot is
+ * empty)
+ */
+extern MOSYS_API int mosys_get_dimm_info(struct mosys_handle *h, int dimm,
+					 struct kv_pair **fields);
+
+/*
+ * mosys_get_ec_info  -  get basic information about an EC
+ *
+ * @h:		handle from mosys_open()
+ * @type:	which EC to ask
+ * @info:	filled with the information
+ *
+ * returns 0 to indicate success
+ * returns -1 and sets errno to indicate failure
+ */
+extern MOSYS_API int mosys_get_ec_info(struct mosys_handle *h,
+				       enum mosys_ec_type type,
+				       struct mosys_ec_info *info);
+
+/*
+ * mosys_eventlog_foreach  -  iterate over the eventlog entries
+ *
+ * @h:		handle from mosys_open()
+ * @fn:		function to call for each entry, oldest first
+ * @arg:	argument to pass to @fn
+ *
+ * Once @fn returns non-zero, the remaining entries are not decoded.
+ *
+ * returns 0 to indicate success
+ * returns -1 and sets errno to indicate failure
+ */
+extern MOSYS_API int mosys_eventlog_foreach(struct mosys_handle *h,
+					    mosys_eventlog_fn fn, void *arg);
+
+#endif /* MOSYS_LIBMOSYS_H__ */
@@ -72,7 +72,28 @@ extern int log_threshold_get(void);
 /* set the current log threshold */
 extern int log_threshold_set(enum log_levels threshold);
 
-/* test if a log level is enabled */
+/* get the current log output file */
+extern FILE *log_outfile_get(void);
+/* set the log output file, NULL for stderr */
+extern void log_outfile_set(FILE *output_file);
+
+/*
+ * test if a log level is enabled, i.e. if messages at @level are printed,
+ * so that callers can skip building expensive messages
+ */
 extern int log_level_enabled(enum log_levels level);
 
+/* write out buffered log messages */
+extern void log_flush(void);
+
+/*
+ * Flight recorder: debug messages which are not printed are kept, with
+ * their arguments, and only formatted if they are shown.
+ */
+
+/* forget the recent messages, e.g. when a command starts */
+extern void log_recorder_reset(void);
+/* print the recent messages which were not printed, and forget them */
+extern void log_recorder_dump(void);
+
 #endif /* MOSYS_LIB_UTIL_LOG_H__ */
@@ -34,8 +34,91 @@
 #ifndef MOSYS_OUTPUT_H__
 #define MOSYS_OUTPUT_H__
 
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 
+/*
+ * Everything printed to the mosys output file is buffered and written
+ * out in bulk: when the buffer fills up, at the end of each command,
+ * when the output file is changed and at exit.
+ */
+
+/*
+ * mosys_write  -  write raw bytes to mosys output
+ *
+ * @data:       bytes to write
+ * @len:        number of bytes
+ *
+ * returns 0 to indicate success
+ * returns -1 if writing out the buffer failed
+ */
+extern int mosys_write(const void *data, size_t len);
+
+/*
+ * mosys_write_escaped  -  write a string to mosys output, escaping a character
+ *
+ * @str:        string to write
+ * @c:          character to prefix with a backslash, e.g. '"'
+ *
+ * returns 0 to indicate success
+ * returns -1 if writing out the buffer failed
+ */
+extern int mosys_write_escaped(const char *str, char c);
+
+/*
+ * mosys_write_json_string  -  write a string to mosys output as JSON
+ *
+ * @str:        string to write, with quotes and escaped as needed
+ *
+ * returns 0 to indicate success
+ * returns -1 if writing out the buffer failed
+ */
+extern int mosys_write_json_string(const char *str);
+
+/* CBOR (RFC 7049) major types */
+#define CBOR_UNSIGNED		0
+#define CBOR_NEGATIVE		1
+#define CBOR_TEXT		3
+#define CBOR_ARRAY		4
+#define CBOR_MAP		5
+
+/* CBOR items which are a single byte */
+#define CBOR_FALSE		0xf4
+#define CBOR_TRUE		0xf5
+#define CBOR_ARRAY_INDEFINITE	0x9f
+#define CBOR_BREAK		0xff
+
+/*
+ * mosys_write_cbor_head  -  write the head of a CBOR item to mosys output
+ *
+ * @major:      CBOR_* major type
+ * @value:      integer value, or length of a string, array or map
+ *
+ * returns 0 to indicate success
+ * returns -1 if writing out the buffer failed
+ */
+extern int mosys_write_cbor_head(int major, uint64_t value);
+
+/*
+ * mosys_write_cbor_int  -  write an integer to mosys output as CBOR
+ */
+extern int mosys_write_cbor_int(int64_t value);
+
+/*
+ * mosys_write_cbor_string  -  write a text string to mosys output as CBOR
+ */
+extern int mosys_write_cbor_string(const char *str);
+
+/*
+ * mosys_output_flush  -  write out buffered mosys output
+ *
+ * returns 0 to indicate success
+ * returns -1 and sets errno to indicate failure
+ */
+extern int mosys_output_flush(void);
+
 /*
  * mosys_printf - standard printf to mosys output file
  *
@@ -48,6 +131,12 @@
 extern int mosys_printf(const char *format, ...)
     __attribute__((format(printf, 1, 2)));
 
+/*
+ * mosys_vprintf - mosys_printf() with a va_list
+ */
+extern int mosys_vprintf(const char *format, va_list ap)
+    __attribute__((format(printf, 1, 0)));
+
 /*
  * print_buffer_to_file  -  print raw buffer to FILE* in hex and ascii
  *
@@ -38,6 +38,7 @@
 #include "lib/elog.h"
 
 struct kv_pair;
+struct kv_schema;
 struct nonspd_mem_info;
 
 /* defined platform types */
@@ -58,6 +59,18 @@ enum arg_type {
 	ARG_TYPE_SUB,		/* branch deeper into command hierachy */
 };
 
+/*
+ * Command flags.
+ *
+ * CMD_FLAG_BOOT_CONSTANT marks getters whose output cannot change until
+ * the next boot, so that long-running callers may cache their results.
+ *
+ * CMD_FLAG_LIST marks getters printing a list of records, which are
+ * printed as an array in JSON output.
+ */
+#define CMD_FLAG_BOOT_CONSTANT	(1 << 0)
+#define CMD_FLAG_LIST		(1 << 1)
+
 /* nested command lists */
 struct platform_intf;
 struct platform_cmd {
@@ -65,6 +78,8 @@ struct platform_cmd {
 	const char *desc;		/* command help text */
 	const char *usage;		/* command usage text */
 	enum arg_type type;		/* argument type */
+	unsigned int flags;		/* CMD_FLAG_* */
+	const struct kv_schema *schema;	/* records printed, if known */
 	union {				/* sub-commands or function */
 		struct platform_cmd *sub;
 		int (*func)(struct platform_intf *intf,
@@ -127,12 +142,16 @@ struct eventlog_cb {
 	int (*print_multi)(struct platform_intf *intf,
 			   struct smbios_log_entry *entry,
 			   int start_id);
+	/* number of records print_multi() prints, set along with it */
+	int (*count_multi)(struct platform_intf *intf,
+			   struct smbios_log_entry *entry);
 	int (*verify)(struct platform_intf *intf,
 	              struct smbios_log_entry *entry);
 	int (*verify_header)(struct elog_header *elog_header);
 	int (*add)(struct platform_intf *intf, enum smbios_log_entry_type type,
 		   size_t data_size, uint8_t *data);
 	int (*clear)(struct platform_intf *intf);
+	/* @data is allocated from the command arena, see context.h */
 	int (*fetch)(struct platform_intf *intf, uint8_t **data,
 		     size_t *length, off_t *header_offset, off_t *data_offset);
 	int (*write)(struct platform_intf *intf, uint8_t *data, size_t length);
@@ -206,15 +225,19 @@ struct platform_intf {
 	int (*destroy)(struct platform_intf *intf);
 };
 
-/* Used for the global linked-list of all platforms. */
-struct platform_list {
-	struct platform_intf *entry;
-	struct platform_list *next;
+/*
+ * Used for the global registry of all platforms.  Entries are placed in
+ * the mosys_platforms linker section by REGISTER_PLATFORM, so the
+ * registry is a static array and nothing needs to run at startup.
+ */
+struct platform_entry {
+	const char *name;		/* name the platform registered as */
+	struct platform_intf *intf;	/* NULL if disabled in this build */
 };
 
 /**
  * REGISTER_PLATFORM - Macro to register a platform_intf in the global
- * platforms list.
+ * platforms registry.
  *
  * @intf:       The platform interface to register.
  * @name:       The name of the platform.  For unibuild devices, this
@@ -235,29 +258,25 @@ struct platform_list {
  *
  * @_intf:        Platform interface.
  * @_name:        The name of the platform.
- * @function_id:  Identifier to be used for the generated function.
+ * @entry_id:     Identifier to be used for the generated registry entry.
  *
- * This works by creating a constructor function [1] which
- * conditionally places the platform interface into the global list
- * before main runs.  In the case that _PLATFORM_IS_ENABLED(_name) can
- * be determined to be false at compile-time, the entire function,
- * including the references to the platform interface, will be
- * optimized away by the compiler.
+ * This works by placing a platform_entry into the mosys_platforms
+ * section, which the linker collects into one array bounded by the
+ * __start_mosys_platforms and __stop_mosys_platforms symbols [1].  In
+ * the case that _PLATFORM_IS_ENABLED(_name) can be determined to be
+ * false at compile-time, the entry does not reference the platform
+ * interface, which will be optimized away by the compiler.
  *
- * [1]: https://gcc.gnu.org/onlinedocs/gcc/Common-Function-Attributes.html
+ * [1]: https://sourceware.org/binutils/docs/ld/Input-Section-Example.html
  */
-#define _REGISTER_PLATFORM(_intf, _name, function_id)                       \
-	static void __attribute__((constructor)) function_id(void)          \
-	{                                                                   \
-		static struct platform_list ent;                            \
-		_Static_assert(                                             \
-			__builtin_constant_p(_name),                        \
-			"Platform names must be a compile-time constant."); \
-		if (_PLATFORM_IS_ENABLED(_name)) {                          \
-			struct platform_intf *intf = &(_intf);              \
-			intf->name = _name;                                 \
-			push_platform_intf(intf, &ent);                     \
-		}                                                           \
+#define _REGISTER_PLATFORM(_intf, _name, entry_id)                          \
+	_Static_assert(__builtin_constant_p(_name),                         \
+		       "Platform names must be a compile-time constant.");  \
+	static const struct platform_entry entry_id                         \
+		__attribute__((section("mosys_platforms"), used,            \
+			       aligned(sizeof(void *)))) = {                \
+		.name = _name,                                              \
+		.intf = _PLATFORM_IS_ENABLED(_name) ? &(_intf) : NULL,      \
 	}
 
 /*
@@ -277,17 +296,6 @@ struct platform_list {
 #define _PLATFORM_IS_ENABLED(name) 1
 #endif
 
-/**
- * push_platform_intf - push an entry to the global platform list
- *
- * @intf:       Platform interface to register.
- * @dest:       Statically-allocated platform_list node.
- *
- * This is an internal helper used by the REGISTER_PLAFTORM macro.
- */
-extern void push_platform_intf(struct platform_intf *intf,
-			       struct platform_list *dest);
-
 /*
  * mosys_platform_setup  -  determine current platform and return handler
  *
@@ -313,6 +321,41 @@ extern void mosys_platform_destroy(struct platform_intf *intf);
  */
 extern void platform_cmd_usage(struct platform_cmd *cmd);
 
+/*
+ * platform_find_cmd  -  resolve a command line to the command it runs
+ *
+ * @intf:	platform interface
+ * @argc:	number of command words
+ * @argv:	command words
+ *
+ * returns the getter or setter which the command words lead to
+ * returns NULL if they do not lead to one
+ */
+extern struct platform_cmd *platform_find_cmd(struct platform_intf *intf,
+					      int argc, char **argv);
+
+/*
+ * platform_find_root_cmd  -  look up a top-level command by name
+ *
+ * @intf:	platform interface
+ * @name:	command word
+ *
+ * returns the command, or NULL if the platform has no such command
+ */
+extern struct platform_cmd *platform_find_root_cmd(struct platform_intf *intf,
+						   const char *name);
+
+/*
+ * platform_find_sub_cmd  -  look up a sub-command by name
+ *
+ * @cmd:	command of type ARG_TYPE_SUB
+ * @name:	command word
+ *
+ * returns the sub-command, or NULL if @cmd has no such sub-command
+ */
+extern struct platform_cmd *platform_find_sub_cmd(struct platform_cmd *cmd,
+						  const char *name);
+
 /*
  * print_tree - print command tree for this platform
  *
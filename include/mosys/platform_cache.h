@@ -0,0 +1,48 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * platform_cache.h: boot-scoped cache of the platform identification
+ */
+
+#ifndef MOSYS_PLATFORM_CACHE_H__
+#define MOSYS_PLATFORM_CACHE_H__
+
+struct sku_info;
+
+/* Where the cache is kept; /run is a tmpfs, so it goes away on reboot */
+#define MOSYS_PLATFORM_CACHE_PATH	"/run/mosys-platform.cache"
+
+/*
+ * platform_cache_lookup  -  look up the platform identified earlier this boot
+ *
+ * @platform:	filled with the name the platform was registered under
+ * @name:	filled with the canonical name set by its probe function
+ * @sku_info:	filled with the SKU information set by its probe function,
+ *		or NULL if it set none
+ *
+ * The cache is only used if it was written during the current boot, on
+ * the same firmware (FRID), by the same mosys binary, and if it is owned
+ * by root or the current user and is not writable by anybody else.
+ * The strings returned are allocated and never need to be freed.
+ *
+ * returns 0 if the cache is valid
+ * returns <0 if there is no valid cache
+ */
+extern int platform_cache_lookup(const char **platform, const char **name,
+				 const struct sku_info **sku_info);
+
+/*
+ * platform_cache_update  -  save the result of platform probing
+ *
+ * @platform:	name the platform was registered under
+ * @name:	canonical name set by its probe function
+ * @sku_info:	SKU information set by its probe function, may be NULL
+ *
+ * Failure to save the cache (e.g. when not running as root) is not an
+ * error, the platform will simply be probed again next time.
+ */
+extern void platform_cache_update(const char *platform, const char *name,
+				  const struct sku_info *sku_info);
+
+#endif /* MOSYS_PLATFORM_CACHE_H__ */
@@ -0,0 +1,126 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * trace.h: per-phase latency tracing
+ */
+
+#ifndef MOSYS_TRACE_H__
+#define MOSYS_TRACE_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Spans are identified by a category (e.g. "cmd", "i2c") and a name.
+ * Neither string is copied, so both must stay valid until the trace is
+ * written out; string literals, __func__ and names taken from static
+ * tables (commands, platforms) are all fine.
+ *
+ * When tracing is off, trace_begin() and trace_end() reduce to a test
+ * of mosys_trace_on.
+ */
+
+/* non-zero while tracing is enabled, do not set directly */
+extern int mosys_trace_on;
+
+/* enable tracing for the rest of the process lifetime */
+extern void trace_enable(void);
+
+/* current monotonic time in nanoseconds */
+extern uint64_t trace_now(void);
+
+/*
+ * trace_add  -  record a span which has already completed
+ *
+ * @cat:	span category
+ * @name:	span name
+ * @start:	start time, from trace_now()
+ * @end:	end time, from trace_now()
+ *
+ * Nothing is recorded while tracing is off.
+ */
+extern void trace_add(const char *cat, const char *name,
+		      uint64_t start, uint64_t end);
+
+/*
+ * trace_add_early  -  record a span which completed before options were parsed
+ *
+ * @cat:	span category
+ * @name:	span name
+ * @start:	start time, from trace_now()
+ * @end:	end time, from trace_now()
+ *
+ * The span is held in a single slot and only recorded if tracing is
+ * enabled afterwards, so that phases such as entering the jail are not
+ * lost to -T while costing nothing when tracing stays off.
+ */
+extern void trace_add_early(const char *cat, const char *name,
+			    uint64_t start, uint64_t end);
+
+/* internal, use trace_begin() and trace_end() */
+extern int trace_span_begin(const char *cat, const char *name);
+extern void trace_span_end(int id);
+
+/*
+ * trace_begin  -  open a span
+ *
+ * @cat:	span category
+ * @name:	span name
+ *
+ * returns a span id to be passed to trace_end()
+ */
+static inline int trace_begin(const char *cat, const char *name)
+{
+	if (!mosys_trace_on)
+		return -1;
+	return trace_span_begin(cat, name);
+}
+
+/*
+ * trace_end  -  close a span opened by trace_begin()
+ *
+ * @id:		span id
+ */
+static inline void trace_end(int id)
+{
+	if (id >= 0)
+		trace_span_end(id);
+}
+
+static inline void trace_scope_end(int *id)
+{
+	trace_end(*id);
+}
+
+/*
+ * TRACE_SCOPE  -  trace from this point to the end of the enclosing block
+ */
+#define TRACE_SCOPE(cat, name)						\
+	int trace_scope_id__						\
+		__attribute__((cleanup(trace_scope_end), unused)) =	\
+		trace_begin((cat), (name))
+
+/*
+ * trace_print_summary  -  print a table of time spent per span
+ *
+ * @fp:		file to print to
+ *
+ * Spans with the same category and name are added up.
+ */
+extern void trace_print_summary(FILE *fp);
+
+/*
+ * trace_write_json  -  write all spans in Chrome trace_event format
+ *
+ * @path:	file to write, which can be loaded in chrome://tracing
+ *
+ * returns 0 to indicate success
+ * returns <0 to indicate failure
+ */
+extern int trace_write_json(const char *path);
+
+/* discard all recorded spans */
+extern void trace_reset(void);
+
+#endif /* MOSYS_TRACE_H__ */
@@ -41,9 +41,12 @@
 #include <sys/ioctl.h>
 
 #include "mosys/alloc.h"
+#include "mosys/context.h"
+#include "mosys/counters.h"
 #include "mosys/globals.h"
 #include "mosys/log.h"
 #include "mosys/platform.h"
+#include "mosys/trace.h"
 
 #include "intf/i2c.h"
 
@@ -64,13 +67,6 @@
 #define BLOCK_WRITE_DELAY	1000
 #define BLOCK_WRITE_RETRIES	32
 
-static struct i2c_handle {
-	struct i2c_addr addr;
-	int fd;
-} i2c_handles[I2C_HANDLE_MAX];
-
-static int i2c_handle_num = 0;
-
 /*
  * i2c_open_dev  -  Open connection to I2C slave address
  *
@@ -83,17 +79,19 @@ static int i2c_handle_num = 0;
  */
 static int i2c_open_dev(struct platform_intf *intf, int bus, int address)
 {
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	struct mosys_i2c_handle *i2c_handles = ctx->i2c_handles;
 	char devf[512];
 	int handle, fd;
 
-	if (i2c_handle_num >= I2C_HANDLE_MAX) {
+	if (ctx->i2c_handle_num >= I2C_HANDLE_MAX) {
 		lprintf(LOG_NOTICE, "Out of I2C handles\n");
 		return -1;
 	}
 
-	for (handle = 0; handle < i2c_handle_num; handle++) {
-		if (i2c_handles[handle].addr.bus == bus &&
-		    i2c_handles[handle].addr.addr == address &&
+	for (handle = 0; handle < ctx->i2c_handle_num; handle++) {
+		if (i2c_handles[handle].bus == bus &&
+		    i2c_handles[handle].addr == address &&
 		    i2c_handles[handle].fd >= 0)
 			return handle;
 	}
@@ -114,14 +112,20 @@ static int i2c_open_dev(struct platform_intf *intf, int bus, int address)
 		return -1;
 	}
 
-	i2c_handles[i2c_handle_num].addr.bus = bus;
-	i2c_handles[i2c_handle_num].addr.addr = address;
-	i2c_handles[i2c_handle_num].fd = fd;
+	i2c_handles[ctx->i2c_handle_num].bus = bus;
+	i2c_handles[ctx->i2c_handle_num].addr = address;
+	i2c_handles[ctx->i2c_handle_num].fd = fd;
 
 	lprintf(LOG_DEBUG, "Opened I2C handle %d to %d-%02x (fd %d)\n",
-	        i2c_handle_num, bus, address, fd);
+	        ctx->i2c_handle_num, bus, address, fd);
+
+	return ctx->i2c_handle_num++;
+}
 
-	return i2c_handle_num++;
+/* file descriptor of a handle returned by i2c_open_dev() */
+static int i2c_handle_fd(int handle)
+{
+	return mosys_ctx_get()->i2c_handles[handle].fd;
 }
 
 /*
@@ -132,26 +136,30 @@ static int i2c_open_dev(struct platform_intf *intf, int bus, int address)
  */
 static void i2c_close_dev(struct platform_intf *intf)
 {
+	struct mosys_ctx *ctx = mosys_ctx_get();
 	int i;
 
 	// close all handles
-	for (i = 0; i < i2c_handle_num; i++) {
-		close(i2c_handles[i].fd);
-		i2c_handles[i].fd = -1;
-		i2c_handles[i].addr.bus = -1;
-		i2c_handles[i].addr.addr = -1;
+	for (i = 0; i < ctx->i2c_handle_num; i++) {
+		close(ctx->i2c_handles[i].fd);
+		ctx->i2c_handles[i].fd = -1;
+		ctx->i2c_handles[i].bus = -1;
+		ctx->i2c_handles[i].addr = -1;
 	}
-	i2c_handle_num = 0;
+	ctx->i2c_handle_num = 0;
 }
 
 static int smbus_read_reg(struct platform_intf *intf, int bus,
 			  int address, int reg, int length, void *data)
 {
+	struct mosys_ctx *ctx = mosys_ctx_get();
 	int handle, fd, i;
 	int ddr4_handle, ddr4_fd;
 	int32_t result;
-	static int read_words = 1;
 	int on_page_1 = 0;
+	TRACE_SCOPE("i2c", __func__);
+
+	counter_add(COUNTER_I2C_OPS, 1);
 
 	if (length < 1 || length > SPD_MAX_LENGTH) {
 		lprintf(LOG_NOTICE, "Invalid I2C read length: %d\n", length);
@@ -166,7 +174,7 @@ static int smbus_read_reg(struct platform_intf *intf, int bus,
 	handle = i2c_open_dev(intf, bus, address);
 	if (handle < 0)
 		return -1;
-	fd = i2c_handles[handle].fd;
+	fd = i2c_handle_fd(handle);
 
 	memset(data, 0, length);
 	i = 0;
@@ -179,18 +187,18 @@ static int smbus_read_reg(struct platform_intf *intf, int bus,
 		    (((char*)data)[DDR4_SPD_REG_DEVICE_TYPE] ==
 		     SPD_DRAM_TYPE_DDR4)) {
 			ddr4_handle = i2c_open_dev(intf, bus, SPD_PAGE_1);
-			ddr4_fd = i2c_handles[ddr4_handle].fd;
+			ddr4_fd = i2c_handle_fd(ddr4_handle);
 			i2c_smbus_write_byte_data(ddr4_fd, 0, 0);
 			on_page_1 = 1;
 		}
-		if (read_words && (i < length - 1)) {
+		if (!ctx->i2c_no_word_reads && (i < length - 1)) {
 			/* Do 2-byte reads whenever possible */
 			result = i2c_smbus_read_word_data(fd, reg + i);
 
                         if (result < 0) {
-				if (read_words) {
+				if (!ctx->i2c_no_word_reads) {
 					/* try again with byte read */
-					read_words = 0;
+					ctx->i2c_no_word_reads = 1;
 					continue;
 				}
 				// COV_NF_START
@@ -220,7 +228,7 @@ static int smbus_read_reg(struct platform_intf *intf, int bus,
 	}
 	if (on_page_1 == 1) {
 		ddr4_handle = i2c_open_dev(intf, bus, SPD_PAGE_0);
-		ddr4_fd = i2c_handles[ddr4_handle].fd;
+		ddr4_fd = i2c_handle_fd(ddr4_handle);
 		i2c_smbus_write_byte_data(ddr4_fd, 0, 0);
 		on_page_1 = 0;
 	}
@@ -241,6 +249,9 @@ static int smbus_read16_dev(struct platform_intf *intf, int bus,
 	int fd, handle, i;
 	int32_t result;
 	uint8_t *dp = data;
+	TRACE_SCOPE("i2c", __func__);
+
+	counter_add(COUNTER_I2C_OPS, 1);
 
 	memset(data, 0, length);
 
@@ -252,7 +263,7 @@ static int smbus_read16_dev(struct platform_intf *intf, int bus,
 	handle = i2c_open_dev(intf, bus, address);
 	if (handle < 0)
 		return -1;
-	fd = i2c_handles[handle].fd;
+	fd = i2c_handle_fd(handle);
 
 	// Write eeprom offset
 	hi = reg >> 8;
@@ -286,6 +297,9 @@ static int smbus_read_raw(struct platform_intf *intf,
 	int result, count;
 	int fd, handle;
 	uint8_t *dp = data;
+	TRACE_SCOPE("i2c", __func__);
+
+	counter_add(COUNTER_I2C_OPS, 1);
 
 	lprintf(LOG_DEBUG,
 	        "%s: Reading byte from %d-%02x\n",
@@ -295,7 +309,7 @@ static int smbus_read_raw(struct platform_intf *intf,
 	handle = i2c_open_dev(intf, bus, address);
 	if (handle < 0)
 		return -1;
-	fd = i2c_handles[handle].fd;
+	fd = i2c_handle_fd(handle);
 
 	for (count = 0; count < length; count++) {
 		/* read byte */
@@ -319,6 +333,9 @@ static int smbus_write_reg(struct platform_intf *intf, int bus,
 	int handle, fd, i;
 	int32_t result;
 	const uint8_t *data_ptr = data;
+	TRACE_SCOPE("i2c", __func__);
+
+	counter_add(COUNTER_I2C_OPS, 1);
 
 	if (length < 1 || length > 256) {
 		lprintf(LOG_NOTICE, "Invalid I2C write length: %d\n", length);
@@ -333,7 +350,7 @@ static int smbus_write_reg(struct platform_intf *intf, int bus,
 	handle = i2c_open_dev(intf, bus, address);
 	if (handle < 0)
 		return -1;
-	fd = i2c_handles[handle].fd;
+	fd = i2c_handle_fd(handle);
 
 	for (i = 0; i < length; i++) {
 		/* write one byte at a time */
@@ -360,9 +377,11 @@ static int smbus_write16_buf(int handle, int reg, const uint8_t *dp, int len)
 {
 	uint8_t buf[32];
 	int32_t result;
-	int fd = i2c_handles[handle].fd;
-	int bus = i2c_handles[handle].addr.bus;
-	int address = i2c_handles[handle].addr.addr;
+	struct mosys_i2c_handle *i2c_handle =
+		&mosys_ctx_get()->i2c_handles[handle];
+	int fd = i2c_handle->fd;
+	int bus = i2c_handle->bus;
+	int address = i2c_handle->addr;
 	int i;
 
 	memset(buf, 0, 32);
@@ -400,6 +419,9 @@ static int smbus_write16_dev(struct platform_intf *intf,
 	int handle, written = 0;
 	const uint8_t *data_ptr = (uint8_t *)data;
 	int buf_len, count;
+	TRACE_SCOPE("i2c", __func__);
+
+	counter_add(COUNTER_I2C_OPS, 1);
 
 	// Open connection to this address
 	handle = i2c_open_dev(intf, bus, address);
@@ -442,6 +464,9 @@ static int smbus_write_raw(struct platform_intf *intf,
 	int handle, fd, count;
 	int32_t result;
 	const uint8_t *data_ptr = data;
+	TRACE_SCOPE("i2c", __func__);
+
+	counter_add(COUNTER_I2C_OPS, 1);
 
 	lprintf(LOG_DEBUG,
 	        "%s: Writing byte to %d-%02x\n",
@@ -451,7 +476,7 @@ static int smbus_write_raw(struct platform_intf *intf,
 	handle = i2c_open_dev(intf, bus, address);
 	if (handle < 0)
 		return -1;
-	fd = i2c_handles[handle].fd;
+	fd = i2c_handle_fd(handle);
 
 	for (count = 0; count < length; count++) {
 		/* write byte */
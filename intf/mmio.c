@@ -40,10 +40,12 @@
 #include <sys/mman.h>
 
 #include "mosys/alloc.h"
+#include "mosys/counters.h"
 #include "mosys/file_backed_range.h"
 #include "mosys/globals.h"
 #include "mosys/log.h"
 #include "mosys/platform.h"
+#include "mosys/trace.h"
 
 #include "intf/mmio.h"
 
@@ -101,6 +103,9 @@ static void *mmio_mmap(struct platform_intf *intf, int flags,
 	int fd;
 	struct file_backed_range *file_range;
 	const char *file_name;
+	TRACE_SCOPE("mmio", __func__);
+
+	counter_add(COUNTER_MMIO_MAPS, 1);
 
 	/* FIXME: hack to get thru SMBIOS parsing in early platform setup */
 	if (mmio_setup(intf) < 0) {
@@ -171,6 +176,7 @@ static int mmio_munmap(struct platform_intf *intf, void *mptr,
 {
 	size_t moffset;
 	struct file_backed_range *file_range;
+	TRACE_SCOPE("mmio", __func__);
 
 	if (mptr == NULL) {
 		return -1;
@@ -215,6 +221,7 @@ static int mmio_mmap_read(struct platform_intf *intf,
                           uint64_t address, int length, void *data)
 {
 	char *mptr;
+	TRACE_SCOPE("mmio", __func__);
 
 	/* Map in the requested address. */
 	mptr = mmio_map(intf, O_RDONLY, address, length);
@@ -46,6 +46,7 @@
 #include "mosys/platform.h"
 #include "mosys/globals.h"
 #include "mosys/log.h"
+#include "mosys/trace.h"
 
 #include "lib/string.h"
 
@@ -93,6 +94,7 @@ static int pci_read_file(struct platform_intf *intf, int bus,
                          int dev, int func, int reg, int length, void *data)
 {
 	int fd, rlen;
+	TRACE_SCOPE("pci", __func__);
 
 	lprintf(LOG_DEBUG,
 	        "pci_read_file: reading %02x:%02x.%x at %02x (%d bytes)\n", bus,
@@ -148,6 +150,7 @@ static int pci_write_file(struct platform_intf *intf, int bus, int dev,
                           int func, int reg, int length, const void *data)
 {
 	int fd, wlen;
+	TRACE_SCOPE("pci", __func__);
 
 	lprintf(LOG_DEBUG,
 	        "pci_write_file: writing %02x:%02x.%x at %02x (%d bytes)\n",
@@ -32,6 +32,7 @@
 #define _GNU_SOURCE
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,6 +40,7 @@
 #include "mosys/alloc.h"
 #include "mosys/log.h"
 #include "mosys/platform.h"
+#include "mosys/trace.h"
 
 #include "lib/acpi.h"
 #include "lib/chromeos.h"
@@ -51,15 +53,26 @@
 #include "lib/smbios.h"
 #include "lib/string.h"
 
-static int get_sku_id(struct platform_intf *intf)
+/* The SKU ID is read only once, even when probing concurrently */
+static pthread_once_t sku_id_once = PTHREAD_ONCE_INIT;
+static int sku_id_value;
+
+static void read_sku_id(void)
 {
 #ifdef CONFIG_PLATFORM_ARCH_X86
-	return smbios_sysinfo_get_sku_number(intf);
+	sku_id_value = smbios_sysinfo_get_sku_number(NULL);
 #else
-	return fdt_get_sku_id();
+	sku_id_value = fdt_get_sku_id();
 #endif
 }
 
+static int get_sku_id(struct platform_intf *intf)
+{
+	pthread_once(&sku_id_once, read_sku_id);
+
+	return sku_id_value;
+}
+
 int cros_config_read_sku_info_fdt(struct platform_intf *intf,
 				  const char *compat_platform_names[],
 				  struct sku_info *sku_info)
@@ -84,6 +97,7 @@ int cros_config_read_default_sku_info_fdt(struct platform_intf *intf,
 	static const int MAX_NAME_LEN = 256;
 	static const int NO_PARTIAL_MATCHES = 0;
 	int sku_id;
+	TRACE_SCOPE("cros_config", __func__);
 
 	sku_id = fdt_get_sku_id();
 	if (sku_id < 0) {
@@ -153,16 +167,12 @@ int cros_config_read_default_sku_info(
 		struct platform_intf *intf, const char *find_platform_names[],
 		struct sku_info *sku_info, int default_sku_id)
 {
-	static ssize_t firmware_name_ret;
-	static char firmware_name[CHROMEOS_FRID_MAXLEN + 1];
+	const char *firmware_name;
 	int sku_id;
+	TRACE_SCOPE("cros_config", __func__);
 
-	if (!firmware_name_ret) {
-		firmware_name_ret = get_firmware_name(
-			firmware_name, ARRAY_SIZE(firmware_name));
-	}
-
-	if (firmware_name_ret < 0) {
+	firmware_name = probe_get_firmware_name();
+	if (!firmware_name) {
 		lprintf(LOG_DEBUG, "%s: Unable to read firmware name\n",
 			__func__);
 		return -1;
@@ -195,6 +205,8 @@ int cros_config_probe_default_sku(struct platform_intf *intf,
 				  const char *platform_names[],
 				  const int default_sku_id)
 {
+	TRACE_SCOPE("cros_config", __func__);
+
 	/* intf->name should match first config name. */
 	int config_map_size = 0;
 	const struct config_map *configs =
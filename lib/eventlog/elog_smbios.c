@@ -34,6 +34,7 @@
  */
 
 #define _XOPEN_SOURCE 600 /* for strptime + snprintf */
+#include <errno.h>
 #include <linux/limits.h>
 #include <stdlib.h>
 #include <inttypes.h>
@@ -45,18 +46,20 @@
 #include <time.h>
 
 #include "mosys/alloc.h"
+#include "mosys/context.h"
 #include "mosys/globals.h"
 #include "mosys/log.h"
 #include "mosys/mosys.h"
 #include "mosys/kv_pair.h"
 #include "mosys/platform.h"
 #include "mosys/output.h"
+#include "mosys/trace.h"
 
 #include "intf/mmio.h"
 
 #include "lib/elog_smbios.h"
+#include "lib/math.h"
 #include "lib/smbios.h"
-#include "lib/val2str.h"
 
 struct smbios_eventlog_iterator {
 	int verbose;
@@ -67,6 +70,21 @@ struct smbios_eventlog_iterator {
 	uint8_t *log_area;    /* log area */
 };
 
+static void eventlog_iterator_init(struct smbios_eventlog_iterator *elog_iter,
+				   uint8_t *data, size_t length,
+				   off_t header_offset, off_t data_offset)
+{
+	elog_iter->log_area = data;
+	elog_iter->verbose = mosys_get_verbosity();
+	elog_iter->log_area_length = length;
+	elog_iter->header_offset = header_offset;
+	elog_iter->data_offset = data_offset;
+	smbios_eventlog_iterator_reset(elog_iter);
+
+	if (elog_iter->verbose > 4)
+		print_buffer(elog_iter->log_area, elog_iter->log_area_length);
+}
+
 /*
  * smbios_new_eventlog_iterator - obtain a new smbios_eventlog_iterator
  *                                for iterating through SMBIOS event log.
@@ -91,15 +109,8 @@ struct smbios_eventlog_iterator *smbios_new_eventlog_iterator(
 
 	/* Allocate and fill in iterator. */
 	elog_iter = mosys_malloc(sizeof(*elog_iter));
-	elog_iter->log_area = data;
-	elog_iter->verbose = mosys_get_verbosity();
-	elog_iter->log_area_length = length;
-	elog_iter->header_offset = header_offset;
-	elog_iter->data_offset = data_offset;
-	smbios_eventlog_iterator_reset(elog_iter);
-
-	if (mosys_get_verbosity() > 4)
-		print_buffer(elog_iter->log_area, elog_iter->log_area_length);
+	eventlog_iterator_init(elog_iter, data, length, header_offset,
+			       data_offset);
 
 	return elog_iter;
 }
@@ -133,6 +144,43 @@ int smbios_eventlog_iterator_reset(struct smbios_eventlog_iterator *elog_iter)
 	return 0;
 }
 
+/*
+ * eventlog_entry_at - validate the event log entry at an offset
+ *
+ * @elog_iter:   eventlog iterator giving the log area
+ * @offset:      offset of the entry in the log area
+ *
+ * returns the entry, or NULL if the log ends there or the entry does not
+ * fit in the log area
+ */
+static struct smbios_log_entry *eventlog_entry_at(
+    const struct smbios_eventlog_iterator *elog_iter, int offset)
+{
+	struct smbios_log_entry *entry;
+
+	/* Cannot proceed past end of log area. */
+	if (offset >= elog_iter->log_area_length)
+		return NULL;
+
+	/* Point to next potential entry */
+	entry = (void *)&elog_iter->log_area[offset];
+
+	/* Ensure the fields read do not exceed the log length. */
+	if (offset + offsetof(typeof(*entry), length) +
+	    sizeof(entry->length) >= elog_iter->log_area_length)
+		return NULL;
+
+	/* Can't go past terminating entry. */
+	if (entry->type == SMBIOS_EVENT_TYPE_ENDLOG)
+		return NULL;
+
+	/* Check if the entry exceeds the length of the log. */
+	if (entry->length + offset >= elog_iter->log_area_length)
+		return NULL;
+
+	return entry;
+}
+
 /*
  * smbios_eventlog_get_next_entry - retrieve next event log entry
  *
@@ -162,24 +210,8 @@ struct smbios_log_entry *smbios_eventlog_get_next_entry(
 		next_offset = elog_iter->current_offset + entry->length;
 	}
 
-	/* Cannot proceed past end of log area. */
-	if (next_offset >= elog_iter->log_area_length)
-		return NULL;
-
-	/* Point to next potential entry */
-	entry =(void *)&elog_iter->log_area[next_offset];
-
-	/* Ensure the fields read do not exceed the log length. */
-	if (next_offset + offsetof(typeof(*entry), length) +
-	    sizeof(entry->length) >= elog_iter->log_area_length)
-		return NULL;
-
-	/* Can't go past terminating entry. */
-	if (entry->type == SMBIOS_EVENT_TYPE_ENDLOG)
-		return NULL;
-
-	/* Check if the entry exceeds the length of the log. */
-	if (entry->length + next_offset >= elog_iter->log_area_length)
+	entry = eventlog_entry_at(elog_iter, next_offset);
+	if (entry == NULL)
 		return NULL;
 
 	/* Advance the offset. */
@@ -232,33 +264,32 @@ void *smbios_eventlog_get_header(struct smbios_eventlog_iterator *elog_iter)
 }
 
 /* SMBIOS Event Log types, SMBIOSv2.4 section 3.3.16.1 */
-static const struct valstr smbios_eventlog_types[] = {
-	{ 0x00, "Reserved" },
-	{ 0x01, "Single-bit ECC memory error" },
-	{ 0x02, "Multi-bit ECC memory error" },
-	{ 0x03, "Parity memory error" },
-	{ 0x04, "Bus timeout" },
-	{ 0x05, "I/O channel check" },
-	{ 0x06, "Software NMI" },
-	{ 0x07, "POST memory resize" },
-	{ 0x08, "POST error" },
-	{ 0x09, "PCI parity error" },
-	{ 0x0a, "PCI system error" },
-	{ 0x0b, "CPU failure" },
-	{ 0x0c, "EISA failsafe timer timeout" },
-	{ 0x0d, "Correctable memory log disabled" },
-	{ 0x0e, "Logging disabled, too many errors" },
-	{ 0x0f, "Reserved" },
-	{ 0x10, "System limit exceeded" },
-	{ 0x11, "Hardware watchdog reset" },
-	{ 0x12, "System configuration information" },
-	{ 0x13, "Hard-disk information" },
-	{ 0x14, "System reconfigured" },
-	{ 0x15, "Uncorrectable CPU-complex error" },
-	{ 0x16, "Log area cleared" },
-	{ 0x17, "System boot" },
-	{ 0xff, "End of log" },
-	{ 0x00, NULL }
+static const char *const smbios_eventlog_types[256] = {
+	[0x00] = "Reserved",
+	[0x01] = "Single-bit ECC memory error",
+	[0x02] = "Multi-bit ECC memory error",
+	[0x03] = "Parity memory error",
+	[0x04] = "Bus timeout",
+	[0x05] = "I/O channel check",
+	[0x06] = "Software NMI",
+	[0x07] = "POST memory resize",
+	[0x08] = "POST error",
+	[0x09] = "PCI parity error",
+	[0x0a] = "PCI system error",
+	[0x0b] = "CPU failure",
+	[0x0c] = "EISA failsafe timer timeout",
+	[0x0d] = "Correctable memory log disabled",
+	[0x0e] = "Logging disabled, too many errors",
+	[0x0f] = "Reserved",
+	[0x10] = "System limit exceeded",
+	[0x11] = "Hardware watchdog reset",
+	[0x12] = "System configuration information",
+	[0x13] = "Hard-disk information",
+	[0x14] = "System reconfigured",
+	[0x15] = "Uncorrectable CPU-complex error",
+	[0x16] = "Log area cleared",
+	[0x17] = "System boot",
+	[0xff] = "End of log",
 };
 
 /*
@@ -271,8 +302,166 @@ static const struct valstr smbios_eventlog_types[] = {
  */
 const char *smbios_get_event_type_string(struct smbios_log_entry *entry)
 {
-	return val2str_default(entry->type, smbios_eventlog_types, NULL);
+	return smbios_eventlog_types[entry->type];
+}
+
+/* days from 1970-01-01 to a date of the proleptic Gregorian calendar */
+static int64_t days_from_civil(int year, int month, int day)
+{
+	int64_t era;
+	int yoe, doy, doe;
+
+	year -= month <= 2;
+	era = (year >= 0 ? year : year - 399) / 400;
+	yoe = year - era * 400;
+	doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+	doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+	return era * 146097 + doe - 719468;
+}
+
+/* date a number of days from 1970-01-01, see days_from_civil() */
+static void civil_from_days(int64_t days, int *year, int *month, int *day)
+{
+	int64_t era;
+	int doe, yoe, doy, mp;
+
+	days += 719468;
+	era = (days >= 0 ? days : days - 146096) / 146097;
+	doe = days - era * 146097;
+	yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	mp = (5 * doy + 2) / 153;
+	*day = doy - (153 * mp + 2) / 5 + 1;
+	*month = mp < 10 ? mp + 3 : mp - 9;
+	*year = yoe + era * 400 + (*month <= 2);
+}
+
+/* value of a BCD field, -1 if it is not BCD or out of range */
+static int bcd_field(uint8_t bcd, int min, int max)
+{
+	int val;
+
+	if ((bcd & 0xf) > 9 || (bcd >> 4) > 9)
+		return -1;
+
+	val = (bcd >> 4) * 10 + (bcd & 0xf);
+
+	return val < min || val > max ? -1 : val;
 }
+
+/*
+ * Offset of local time from UTC, known to hold from tz_cache.start to
+ * tz_cache.end.  Entries are logged in time order, so that one lookup
+ * serves many of them.  It is dropped whenever an eventlog is fetched, so
+ * that each command, e.g. in the daemon, sees the current time zone.
+ */
+static __thread struct {
+	time_t start;
+	time_t end;
+	long offset;
+} tz_cache = { .start = 1, .end = 0 };
+
+/* pick up changes to TZ or /etc/localtime since the last command */
+static void tz_cache_reset(void)
+{
+	tzset();
+	tz_cache.start = 1;
+	tz_cache.end = 0;
+}
+
+/* the local time of no time zone changes twice in this span */
+#define TZ_CACHE_SPAN	(7 * 24 * 60 * 60)
+
+static long tz_offset_at(time_t time)
+{
+	struct tm tm;
+
+	if (!localtime_r(&time, &tm))
+		return 0;
+
+	return tm.__tm_gmtoff;
+}
+
+/* offset of local time from UTC at a time */
+static long tz_offset(time_t time)
+{
+	time_t lo, hi, mid;
+	long offset;
+
+	if (time >= tz_cache.start && time <= tz_cache.end)
+		return tz_cache.offset;
+
+	offset = tz_offset_at(time);
+
+	/* bisect to the change of offset on either side, if there is one */
+	lo = time;
+	hi = time + TZ_CACHE_SPAN;
+	if (tz_offset_at(hi) != offset) {
+		while (hi - lo > 1) {
+			mid = lo + (hi - lo) / 2;
+			if (tz_offset_at(mid) == offset)
+				lo = mid;
+			else
+				hi = mid;
+		}
+		hi = lo;
+	}
+	tz_cache.end = hi;
+
+	lo = time - TZ_CACHE_SPAN;
+	hi = time;
+	if (tz_offset_at(lo) != offset) {
+		while (hi - lo > 1) {
+			mid = lo + (hi - lo) / 2;
+			if (tz_offset_at(mid) == offset)
+				hi = mid;
+			else
+				lo = mid;
+		}
+		lo = hi;
+	}
+	tz_cache.start = lo;
+	tz_cache.offset = offset;
+
+	return offset;
+}
+
+static void put_digits(char *buf, int val, int digits)
+{
+	while (digits--) {
+		buf[digits] = '0' + val % 10;
+		val /= 10;
+	}
+}
+
+/* format a time as "YYYY-MM-DD HH:MM:SS", buf must have room for 20 chars */
+static void format_time(char *buf, int64_t time)
+{
+	int64_t days = time / 86400;
+	int secs = time % 86400;
+	int year, month, day;
+
+	if (secs < 0) {
+		secs += 86400;
+		days--;
+	}
+	civil_from_days(days, &year, &month, &day);
+
+	put_digits(buf, year, 4);
+	buf[4] = '-';
+	put_digits(buf + 5, month, 2);
+	buf[7] = '-';
+	put_digits(buf + 8, day, 2);
+	buf[10] = ' ';
+	put_digits(buf + 11, secs / 3600, 2);
+	buf[13] = ':';
+	put_digits(buf + 14, secs / 60 % 60, 2);
+	buf[16] = ':';
+	put_digits(buf + 17, secs % 60, 2);
+	buf[19] = '\0';
+}
+
 /*
  * smbios_eventlog_print_timestamp - forms the key-value pair for event
  * timestamp
@@ -287,7 +476,7 @@ void smbios_eventlog_print_timestamp(struct platform_intf *intf,
 				     struct smbios_log_entry *entry,
 				     struct kv_pair *kv)
 {
-	char tm_string[40];
+	char tm_string[20];
 	time_t time;
 
 	if (!intf || !entry || !kv)
@@ -304,11 +493,10 @@ void smbios_eventlog_print_timestamp(struct platform_intf *intf,
 		return;
 	}
 
-	strftime(tm_string, sizeof(tm_string),
-		 "%Y-%m-%d %H:%M:%S", localtime(&time));
+	format_time(tm_string, (int64_t)time + tz_offset(time));
 
-	/* print the timestamp */
-	kv_pair_add(kv, "timestamp", tm_string);
+	/* print the timestamp, binary output keeps seconds since the epoch */
+	kv_pair_fmt_int(kv, "timestamp", time, "%s", tm_string);
 }
 
 
@@ -323,29 +511,189 @@ void smbios_eventlog_print_timestamp(struct platform_intf *intf,
  */
 int smbios_eventlog_event_time(struct smbios_log_entry *entry, time_t *time)
 {
-	int ret;
-	struct tm tm;
-	char tm_string[20];
-	const char *tm_format = "%y-%m-%d%t%H:%M:%S";
+	int year, month, day, hour, minute, second;
 
 	MOSYS_DCHECK(time);
 
-	ret = 0;
-	/* make certain _all_ members of tm get initialized */
-	memset(&tm, 0, sizeof(tm));
-	snprintf(tm_string, sizeof(tm_string), "%02x-%02x-%02x %02x:%02x:%02x",
-		 entry->year, entry->month, entry->day,
-		 entry->hour, entry->minute, entry->second);
+	/* the ranges strptime() used to accept */
+	year = bcd_field(entry->year, 0, 99);
+	month = bcd_field(entry->month, 1, 12);
+	day = bcd_field(entry->day, 1, 31);
+	hour = bcd_field(entry->hour, 0, 23);
+	minute = bcd_field(entry->minute, 0, 59);
+	second = bcd_field(entry->second, 0, 61);
+	/* strptime() stopped at a non-digit in the seconds, but kept going */
+	if (second < 0 && (entry->second >> 4) <= 9 &&
+	    (entry->second & 0xf) > 9)
+		second = entry->second >> 4;
+	if (year < 0 || month < 0 || day < 0 || hour < 0 || minute < 0 ||
+	    second < 0)
+		return -1;
+
+	/* entries are logged in UTC, years 69 to 99 are in the 1900s */
+	year += year < 69 ? 2000 : 1900;
+	*time = days_from_civil(year, month, day) * 86400 +
+		hour * 3600 + minute * 60 + second;
 
-	if (strptime(tm_string, tm_format, &tm) == NULL) {
-		ret = -1;
-	} else {
-		/* Set DST flag to -1 to indicate "not available" and let
-		 * system determine if DST is on based on date */
-		tm.tm_isdst = -1;
+	return 0;
+}
+
+int smbios_eventlog_time_key_parse(const char *str, uint64_t *key)
+{
+	const char *formats[] = {
+		"%Y-%m-%d %H:%M:%S", "%Y-%m-%d %H:%M", "%Y-%m-%d",
+	};
+	struct smbios_log_entry entry;
+	struct tm tm, utc;
+	const char *end;
+	time_t time;
+	size_t i;
+
+	MOSYS_DCHECK(key);
+
+	for (i = 0; i < ARRAY_SIZE(formats); i++) {
+		memset(&tm, 0, sizeof(tm));
+		end = strptime(str, formats[i], &tm);
+		if (end && !*end)
+			break;
+	}
+	if (i == ARRAY_SIZE(formats)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* entries are logged in UTC and printed in local time */
+	tm.tm_isdst = -1;
+	time = mktime(&tm);
+	if (!gmtime_r(&time, &utc)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (utc.tm_year < 69) {
+		*key = 0;
+		return 0;
+	}
+	if (utc.tm_year > 168) {
+		*key = UINT64_MAX;
+		return 0;
+	}
+
+	entry.year = bin2bcd(utc.tm_year % 100);
+	entry.month = bin2bcd(utc.tm_mon + 1);
+	entry.day = bin2bcd(utc.tm_mday);
+	entry.hour = bin2bcd(utc.tm_hour);
+	entry.minute = bin2bcd(utc.tm_min);
+	entry.second = bin2bcd(utc.tm_sec);
+	*key = smbios_eventlog_time_key(&entry);
+
+	return 0;
+}
+
+int smbios_eventlog_snapshot_fetch(struct platform_intf *intf,
+				   struct smbios_eventlog_snapshot *elog)
+{
+	int ret, trace_id;
+
+	MOSYS_DCHECK(intf);
+	MOSYS_DCHECK(elog);
+
+	if (!intf->cb->eventlog || !intf->cb->eventlog->fetch) {
+		errno = ENOSYS;
+		return -1;
+	}
+
+	tz_cache_reset();
 
-		*time = mktime(&tm);
-		*time += tm.__tm_gmtoff; /* force adjust for timezone */
+	trace_id = trace_begin("eventlog", "fetch");
+	ret = intf->cb->eventlog->fetch(intf, &elog->data, &elog->length,
+					&elog->header_offset,
+					&elog->data_offset);
+	trace_end(trace_id);
+	if (ret)
+		return -1;
+
+	elog->iter = mosys_arena_alloc(mosys_cmd_arena(), sizeof(*elog->iter));
+	elog->offsets = NULL;
+	elog->entries = 0;
+	elog->corrupt = 0;
+	eventlog_iterator_init(elog->iter, elog->data, elog->length,
+			       elog->header_offset, elog->data_offset);
+
+	return 0;
+}
+
+int smbios_eventlog_snapshot_index(struct smbios_eventlog_snapshot *elog)
+{
+	struct smbios_eventlog_iterator *elog_iter = elog->iter;
+	struct smbios_log_entry *entry;
+	int offset, count = 0;
+
+	if (elog->offsets)
+		return elog->corrupt ? -1 : 0;
+
+	/* count the entries first, so the index is allocated once */
+	offset = elog_iter->data_offset;
+	while ((entry = eventlog_entry_at(elog_iter, offset)) != NULL &&
+	       entry->length) {
+		offset += entry->length;
+		count++;
+	}
+	elog->corrupt = entry != NULL;
+
+	elog->offsets = mosys_arena_alloc(mosys_cmd_arena(),
+					  (count + 1) * sizeof(*elog->offsets));
+	elog->entries = count;
+
+	offset = elog_iter->data_offset;
+	for (count = 0; count < elog->entries; count++) {
+		entry = (void *)&elog_iter->log_area[offset];
+		if (elog_iter->verbose > 5)
+			print_buffer(entry, entry->length);
+		elog->offsets[count] = offset;
+		offset += entry->length;
+	}
+	elog->offsets[count] = offset;
+
+	return elog->corrupt ? -1 : 0;
+}
+
+uint32_t smbios_eventlog_entry_hash(const struct smbios_log_entry *entry)
+{
+	const uint8_t *data = (const uint8_t *)entry;
+	uint32_t hash = 2166136261u;
+	int i;
+
+	for (i = 0; i < entry->length; i++) {
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+int smbios_eventlog_snapshot_foreach(
+	struct platform_intf *intf, struct smbios_eventlog_snapshot *elog,
+	smbios_eventlog_verify_header verify,
+	smbios_eventlog_callback callback, void *arg)
+{
+	struct smbios_log_entry *entry;
+	int complete = 0;
+	int ret = 0;
+
+	MOSYS_DCHECK(elog);
+	MOSYS_DCHECK(callback);
+
+	if (verify != NULL &&
+	    verify(smbios_eventlog_get_header(elog->iter)) < 0)
+		return -1;
+
+	/* Cycle through each event. */
+	smbios_eventlog_iterator_reset(elog->iter);
+	while ((entry = smbios_eventlog_get_next_entry(elog->iter)) != NULL) {
+		ret |= callback(intf, entry, arg, &complete);
+		if (complete)
+			break;
 	}
 
 	return ret;
@@ -366,46 +714,14 @@ int smbios_eventlog_foreach_event(struct platform_intf *intf,
                                   smbios_eventlog_verify_header verify,
                                   smbios_eventlog_callback callback, void *arg)
 {
-	uint8_t *data;
-	size_t length;
-	off_t header_offset, data_offset;
-	struct smbios_eventlog_iterator *elog_iter;
-	struct smbios_log_entry *entry;
-	int complete;
-	int ret;
+	struct smbios_eventlog_snapshot elog;
 
 	MOSYS_DCHECK(intf);
 	MOSYS_DCHECK(callback);
 
-	if (intf->cb->eventlog->fetch(intf, &data, &length, &header_offset,
-				      &data_offset)) {
+	if (smbios_eventlog_snapshot_fetch(intf, &elog) < 0)
 		return -1;
-	}
-
-	/* Obtain handle to eventlog. */
-	elog_iter = smbios_new_eventlog_iterator(intf, data, length,
-						 header_offset, data_offset);
 
-	if (verify != NULL) {
-		void *eventlog_header = smbios_eventlog_get_header(elog_iter);
-
-		if (verify(eventlog_header) < 0) {
-			ret = -1;
-			goto smbios_eventlog_foreach_event_out;
-		}
-	}
-
-	/* Cycle through each event. */
-	complete = 0;
-	ret = 0;
-	while ((entry = smbios_eventlog_get_next_entry(elog_iter)) != NULL) {
-		ret |= callback(intf, entry, arg, &complete);
-		if (complete) {
-			break;
-		}
-	}
-
-smbios_eventlog_foreach_event_out:
-	smbios_free_eventlog_iterator(elog_iter);
-	return ret;
+	return smbios_eventlog_snapshot_foreach(intf, &elog, verify, callback,
+						arg);
 }
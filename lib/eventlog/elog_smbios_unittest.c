@@ -0,0 +1,174 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// cmocka doesn't include some headers it uses, e.g. setjmp. Prevent
+// clang-format from putting the headers in order, so it gets the above
+// includes.
+// clang-format off
+#include <cmocka.h>
+// clang-format on
+
+#include "mosys/kv_pair.h"
+#include "mosys/platform.h"
+
+#include "lib/elog_smbios.h"
+
+static void event_time_decodes_bcd(void **state)
+{
+	struct smbios_log_entry entry = {
+		.year = 0x20, .month = 0x02, .day = 0x29,
+		.hour = 0x23, .minute = 0x59, .second = 0x58,
+	};
+	time_t time;
+
+	assert_int_equal(smbios_eventlog_event_time(&entry, &time), 0);
+	assert_int_equal(time, 1583020798);
+
+	/* years 69 to 99 are in the 1900s */
+	entry.year = 0x99;
+	entry.month = 0x12;
+	entry.day = 0x31;
+	assert_int_equal(smbios_eventlog_event_time(&entry, &time), 0);
+	assert_int_equal(time, 946684798);
+
+	entry.year = 0x69;
+	entry.month = 0x01;
+	entry.day = 0x01;
+	entry.hour = entry.minute = entry.second = 0;
+	assert_int_equal(smbios_eventlog_event_time(&entry, &time), 0);
+	assert_int_equal(time, -365 * 86400);
+}
+
+static void event_time_rejects_bad_fields(void **state)
+{
+	struct smbios_log_entry entry = {
+		.year = 0x20, .month = 0x13, .day = 0x01,
+	};
+	time_t time;
+
+	assert_int_equal(smbios_eventlog_event_time(&entry, &time), -1);
+	entry.month = 0x1a;
+	assert_int_equal(smbios_eventlog_event_time(&entry, &time), -1);
+	entry.month = 0x01;
+	entry.hour = 0x24;
+	assert_int_equal(smbios_eventlog_event_time(&entry, &time), -1);
+	entry.hour = 0x00;
+	entry.day = 0x00;
+	assert_int_equal(smbios_eventlog_event_time(&entry, &time), -1);
+}
+
+static int save_timestamp(struct kv_pair *kv, void *arg)
+{
+	strcpy(arg, kv_pair_get(kv, "timestamp"));
+	return 0;
+}
+
+static void print_timestamp(struct smbios_log_entry *entry)
+{
+	struct platform_intf intf;
+	struct kv_pair *kv = kv_pair_new();
+
+	smbios_eventlog_print_timestamp(&intf, entry, kv);
+	kv_pair_print(kv);
+	kv_pair_free(kv);
+}
+
+static void timestamps_print_in_local_time(void **state)
+{
+	struct smbios_log_entry entry = {
+		.year = 0x20, .month = 0x03, .day = 0x08,
+		.hour = 0x06, .minute = 0x59, .second = 0x59,
+	};
+	char buf[64];
+
+	kv_pair_set_sink(save_timestamp, buf);
+
+	/* the switch to daylight saving time is at 07:00 UTC */
+	print_timestamp(&entry);
+	assert_string_equal(buf, "2020-03-08 01:59:59");
+	entry.hour = 0x07;
+	entry.minute = entry.second = 0x00;
+	print_timestamp(&entry);
+	assert_string_equal(buf, "2020-03-08 03:00:00");
+
+	/* and back, before the offset cached above */
+	entry.year = 0x19;
+	entry.month = 0x11;
+	entry.day = 0x03;
+	entry.hour = 0x05;
+	entry.minute = 0x59;
+	entry.second = 0x59;
+	print_timestamp(&entry);
+	assert_string_equal(buf, "2019-11-03 01:59:59");
+	entry.hour = 0x06;
+	entry.minute = entry.second = 0x00;
+	print_timestamp(&entry);
+	assert_string_equal(buf, "2019-11-03 01:00:00");
+
+	/* fields which are not BCD are printed as they are */
+	entry.minute = 0x6a;
+	print_timestamp(&entry);
+	assert_string_equal(buf, "2019-11-03 06:6a:00");
+
+	kv_pair_set_sink(NULL, NULL);
+}
+
+static int fetch_nothing(struct platform_intf *intf, uint8_t **data,
+			 size_t *length, off_t *header_offset,
+			 off_t *data_offset)
+{
+	return -1;
+}
+
+static void time_zone_changes_are_seen(void **state)
+{
+	struct eventlog_cb eventlog = { .fetch = fetch_nothing };
+	struct platform_cb cb = { .eventlog = &eventlog };
+	struct platform_intf intf = { .cb = &cb };
+	struct smbios_eventlog_snapshot elog;
+	struct smbios_log_entry entry = {
+		.year = 0x20, .month = 0x06, .day = 0x01,
+		.hour = 0x12, .minute = 0x00, .second = 0x00,
+	};
+	char buf[64];
+
+	kv_pair_set_sink(save_timestamp, buf);
+
+	print_timestamp(&entry);
+	assert_string_equal(buf, "2020-06-01 08:00:00");
+
+	/* each command fetches the log, and sees the new time zone */
+	setenv("TZ", "UTC0", 1);
+	smbios_eventlog_snapshot_fetch(&intf, &elog);
+	print_timestamp(&entry);
+	assert_string_equal(buf, "2020-06-01 12:00:00");
+
+	setenv("TZ", "EST5EDT,M3.2.0,M11.1.0", 1);
+	smbios_eventlog_snapshot_fetch(&intf, &elog);
+	kv_pair_set_sink(NULL, NULL);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(event_time_decodes_bcd),
+		cmocka_unit_test(event_time_rejects_bad_fields),
+		cmocka_unit_test(timestamps_print_in_local_time),
+		cmocka_unit_test(time_zone_changes_are_seen),
+	};
+
+	/* a time zone which needs no tzdata files */
+	setenv("TZ", "EST5EDT,M3.2.0,M11.1.0", 1);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,149 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// cmocka doesn't include some headers it uses, e.g. setjmp. Prevent
+// clang-format from putting the headers in order, so it gets the above
+// includes.
+// clang-format off
+#include <cmocka.h>
+// clang-format on
+
+#include "mosys/kv_pair.h"
+#include "mosys/platform.h"
+
+#include "lib/elog.h"
+#include "lib/elog_smbios.h"
+
+#define ELOG_DATA_KEY(key, type)	key,
+static const char *const data_keys[] = {
+	ELOG_DATA_FIELDS(ELOG_DATA_KEY)
+	NULL
+};
+#undef ELOG_DATA_KEY
+
+static int is_data_key(const char *key)
+{
+	int i;
+
+	for (i = 0; data_keys[i]; i++) {
+		if (!strcmp(data_keys[i], key))
+			return 1;
+	}
+
+	return 0;
+}
+
+/* every key a decoder prints must be in ELOG_DATA_FIELDS */
+static void data_keys_are_listed(void **state)
+{
+	union {
+		struct smbios_log_entry entry;
+		uint8_t buf[64];
+	} e;
+	struct platform_intf intf;
+	struct kv_pair *kv;
+	int type, len, i;
+
+	for (type = 0; type <= 0xff; type++) {
+		for (len = sizeof(e.entry); len <= sizeof(e.buf); len++) {
+			for (i = 0; i < sizeof(e.buf); i++)
+				e.buf[i] = type * 37 + len * 11 + i;
+			e.entry.type = type;
+			e.entry.length = len;
+
+			kv = kv_pair_new();
+			elog_print_data(&intf, &e.entry, kv);
+			for (i = 0; i < kv_pair_count(kv); i++) {
+				if (!is_data_key(kv_pair_key(kv, i)))
+					fail_msg("type 0x%02x prints \"%s\"",
+						 type, kv_pair_key(kv, i));
+			}
+			kv_pair_free(kv);
+		}
+	}
+}
+
+static void data_skipped_when_filtered(void **state)
+{
+	union {
+		struct smbios_log_entry entry;
+		uint8_t buf[64];
+	} e = { .entry = { .type = SMBIOS_EVENT_TYPE_BOOT, .length = 64 } };
+	struct platform_intf intf;
+	struct kv_pair *kv = kv_pair_new();
+
+	assert_int_equal(elog_print_data(&intf, &e.entry, kv), 1);
+	assert_int_not_equal(kv_pair_count(kv), 0);
+	kv_pair_free(kv);
+
+	mosys_set_kv_pair_style(KV_STYLE_SINGLE);
+	kv_set_single_key("entry,type");
+	kv = kv_pair_new();
+	assert_int_equal(elog_print_data(&intf, &e.entry, kv), 0);
+	assert_int_equal(kv_pair_count(kv), 0);
+	kv_pair_free(kv);
+
+	kv_set_single_key("type,count");
+	kv = kv_pair_new();
+	assert_int_equal(elog_print_data(&intf, &e.entry, kv), 1);
+	assert_string_equal(kv_pair_key(kv, 0), "count");
+	kv_pair_free(kv);
+
+	kv_set_single_key(NULL);
+	mosys_set_kv_pair_style(KV_STYLE_VALUE);
+}
+
+static int count_record(struct kv_pair *kv_list, void *arg)
+{
+	(*(int *)arg)++;
+	return 0;
+}
+
+/* entries must be numbered the same whether or not they are decoded */
+static void multi_count_matches_print(void **state)
+{
+	union {
+		struct smbios_log_entry entry;
+		uint8_t buf[64];
+	} e;
+	struct platform_intf intf;
+	int type, seed, i, printed;
+
+	memset(&intf, 0, sizeof(intf));
+	kv_pair_set_sink(count_record, &printed);
+	for (type = 0; type <= 0xff; type++) {
+		for (seed = 0; seed < 64; seed++) {
+			for (i = 0; i < sizeof(e.buf); i++)
+				e.buf[i] = seed * (i + 1);
+			e.entry.type = type;
+			e.entry.length = sizeof(e.buf);
+
+			printed = 0;
+			assert_int_equal(elog_print_multi(&intf, &e.entry, 0),
+					 printed);
+			assert_int_equal(elog_count_multi(&intf, &e.entry),
+					 printed);
+		}
+	}
+	kv_pair_set_sink(NULL, NULL);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(data_keys_are_listed),
+		cmocka_unit_test(data_skipped_when_filtered),
+		cmocka_unit_test(multi_count_matches_print),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
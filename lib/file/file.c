@@ -39,6 +39,7 @@
 #include <sys/types.h>
 
 #include "mosys/alloc.h"
+#include "mosys/counters.h"
 #include "mosys/globals.h"
 #include "mosys/log.h"
 #include "mosys/mosys.h"
@@ -71,6 +72,7 @@ int file_open(const char *file, int rw)
 				return -1;
 			}
 			/* created ok, now return the descriptor */
+			counter_add(COUNTER_FILES_OPENED, 1);
 			return fd;
 		} else {
 			lprintf(LOG_DEBUG, "File %s does not exist\n", file);
@@ -85,6 +87,7 @@ int file_open(const char *file, int rw)
 			lperror(LOG_NOTICE, "Unable to open file %s", file);
 			return -1;
 		}
+		counter_add(COUNTER_FILES_OPENED, 1);
 		return fd;
 	}
 
@@ -139,6 +142,7 @@ int file_open(const char *file, int rw)
 		return -1;
 	}
 
+	counter_add(COUNTER_FILES_OPENED, 1);
 	return fd;
 }
 
@@ -161,8 +165,10 @@ ssize_t read_file(const char *path, char *buf, size_t buf_sz,
 			__func__, path);
 		return -1;
 	}
+	counter_add(COUNTER_FILES_OPENED, 1);
 
 	bytes_read = fread(buf, 1, buf_sz - 1, f);
+	counter_add(COUNTER_BYTES_READ, bytes_read);
 	if (ferror(f)) {
 		lprintf(log_level, "%s: File \"%s\" in error state\n",
 			__func__, path);
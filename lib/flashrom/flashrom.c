@@ -36,6 +36,7 @@
 #include <inttypes.h>
 #include <limits.h>
 #include <linux/limits.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
@@ -45,21 +46,28 @@
 #include <sys/wait.h>
 
 #include "mosys/alloc.h"
+#include "mosys/counters.h"
 #include "mosys/globals.h"
 #include "mosys/log.h"
 #include "mosys/platform.h"
+#include "mosys/trace.h"
 
 #include "lib/flashrom.h"
 #include "lib/math.h"
 
 #define MAX_ARRAY_SIZE 256
 
+/* only one flashrom may drive the host programmer at a time */
+static pthread_mutex_t flashrom_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /*
  * do_cmd - Execute a command
  *
  * @cmd:	Command to execute.
  * @argv:	Arguments. By convention, argv[0] is cmd.
  *
+ * Commands run by different threads are run one after the other.
+ *
  * returns -1 to indicate error, 0 to indicate success
  */
 static int do_cmd(const char *cmd, char *const *argv)
@@ -69,11 +77,14 @@ static int do_cmd(const char *cmd, char *const *argv)
 	int status = 0;
 	int i;
 	int null_fd;
+	TRACE_SCOPE("exec", cmd);
 
 	null_fd = open("/dev/null", O_WRONLY);
 	if (null_fd < 0)
 		return -1;
 
+	pthread_mutex_lock(&flashrom_lock);
+
 	if (argv != NULL) {
 		for (i = 0; argv[i] != NULL; i++) {
 			lprintf(LOG_DEBUG, "%s ", argv[i]);
@@ -94,6 +105,7 @@ static int do_cmd(const char *cmd, char *const *argv)
 		lperror(LOG_ERR, "%s: Failed to run %s", __func__, cmd);
 		rc = -1;
 	} else { /* parent */
+		counter_add(COUNTER_CHILD_PROCS, 1);
 		if (waitpid(pid, &status, 0) > 0) {
 			if (WIFEXITED(status)) {
 				if (WEXITSTATUS(status) != 0) {
@@ -113,6 +125,7 @@ static int do_cmd(const char *cmd, char *const *argv)
 		}
 	}
 
+	pthread_mutex_unlock(&flashrom_lock);
 	close(null_fd);
 	return rc;
 }
@@ -176,7 +189,8 @@ flashrom_read_exit_0:
 	return rc;
 }
 
-int flashrom_read_by_name(uint8_t **buf, const char *region)
+int flashrom_read_by_name(struct mosys_arena *arena, uint8_t **buf,
+			  const char *region)
 {
 	int fd, rc = -1;
 	struct stat s;
@@ -217,17 +231,19 @@ int flashrom_read_by_name(uint8_t **buf, const char *region)
 	fd = open(full_filename, O_RDONLY);
 	if (fstat(fd, &s) < 0) {
 		lprintf(LOG_DEBUG, "%s: Cannot stat %s\n",__func__, full_filename);
-		goto flashrom_read_exit_2;
+		goto flashrom_read_exit_3;
 	}
 
-	*buf = mosys_malloc(s.st_size);
+	*buf = mosys_arena_alloc(arena, s.st_size);
 	if (read(fd, *buf, s.st_size) < 0) {
 		lperror(LOG_DEBUG, "%s: Unable to read image", full_filename);
-		free(*buf);
-		goto flashrom_read_exit_2;
+		goto flashrom_read_exit_3;
 	}
 
 	rc = s.st_size;
+flashrom_read_exit_3:
+	if (fd >= 0)
+		close(fd);
 flashrom_read_exit_2:
 	for (i = 0; args[i] != NULL; i++)
 	  free(args[i]);
@@ -304,13 +320,14 @@ flashrom_write_exit_0:
 }
 
 int flashrom_read_host_firmware_region(struct platform_intf *intf,
-							uint8_t **buf)
+				       struct mosys_arena *arena,
+				       uint8_t **buf)
 {
 	int rc = -1;
 	const char *regions[] = { "COREBOOT", "BOOT_STUB" };
 
 	for (int i = 0; i < ARRAY_SIZE(regions); i++) {
-		rc = flashrom_read_by_name(buf, regions[i]);
+		rc = flashrom_read_by_name(arena, buf, regions[i]);
 		if (rc > 0)
 			break;
 	}
@@ -29,6 +29,7 @@
  */
 
 #include <ctype.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <string.h>
 #include <limits.h>
@@ -47,7 +48,7 @@
 #include "lib/smbios.h"
 #include "lib/string.h"
 
-static ssize_t get_frid(char *buf, size_t buf_sz)
+ssize_t get_frid(char *buf, size_t buf_sz)
 {
 #ifdef CONFIG_PLATFORM_ARCH_X86
 	return acpi_get_frid(buf, buf_sz);
@@ -82,23 +83,46 @@ ssize_t get_firmware_name(char *buf, size_t buf_sz)
 	return firmware_name_end - buf + 1;
 }
 
-int probe_frid(const char *const frids[])
+/*
+ * The identity values below are read at most once per process, even
+ * when several platforms are probed concurrently.  If reading fails the
+ * first time through, later callers see the same failure.
+ */
+static pthread_once_t firmware_name_once = PTHREAD_ONCE_INIT;
+static ssize_t firmware_name_ret;
+static char firmware_name[CHROMEOS_FRID_MAXLEN + 1];
+
+static void read_firmware_name(void)
 {
-	static ssize_t firmware_name_ret;
-	static char firmware_name[CHROMEOS_FRID_MAXLEN + 1];
+	firmware_name_ret = get_firmware_name(firmware_name,
+					      ARRAY_SIZE(firmware_name));
+}
 
-	if (!firmware_name_ret) {
-		firmware_name_ret = get_firmware_name(
-			firmware_name, ARRAY_SIZE(firmware_name));
-	}
+const char *probe_get_firmware_name(void)
+{
+	pthread_once(&firmware_name_once, read_firmware_name);
 
-	/*
-	 * On the second call to probe_frid, we won't re-run the logic
-	 * above. If it failed the first time thru, we still want to
-	 * return a failure.
-	 */
-	if (firmware_name_ret < 0)
-		return firmware_name_ret;
+	return firmware_name_ret < 0 ? NULL : firmware_name;
+}
+
+static pthread_once_t product_name_once = PTHREAD_ONCE_INIT;
+static char *product_name;
+
+static void read_product_name(void)
+{
+	/* TODO(jrosenth): getting the product name does not actually
+	   require the platform_intf.  Remove this from
+	   smbios_sysinfo_get_name and clean up all probe_smbios calls
+	   to not pass intf. */
+	product_name = smbios_sysinfo_get_name(NULL);
+}
+
+int probe_frid(const char *const frids[])
+{
+	const char *firmware_name = probe_get_firmware_name();
+
+	if (!firmware_name)
+		return -1;
 
 	if (strlfind(firmware_name, frids, 0)) {
 		lprintf(LOG_DEBUG, "%s: matched id \"%s\"\n", __func__,
@@ -111,19 +135,12 @@ int probe_frid(const char *const frids[])
 
 int probe_smbios(struct platform_intf *intf, const char *const ids[])
 {
-	static char *id = NULL;
+	const char *id;
 	int ret = 0;
 
-	if (id)
-		goto probe_smbios_cmp;
-
-	/* TODO(jrosenth): getting the product name does not actually
-	   require the platform_intf.  Remove this from
-	   smbios_sysinfo_get_name and clean up all probe_smbios calls
-	   to not pass intf. */
-	id = smbios_sysinfo_get_name(intf);
+	pthread_once(&product_name_once, read_product_name);
+	id = product_name;
 
-probe_smbios_cmp:
 	if (!id) {
 		ret = 0;
 		lprintf(LOG_SPEW, "%s: cannot find product name\n", __func__);
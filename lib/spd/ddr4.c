@@ -126,8 +126,9 @@ int spd_print_field_ddr4(struct platform_intf *intf, struct kv_pair *kv,
 
 	case SPD_GET_MFG_LOC:
 	{
-		kv_pair_fmt(kv, "mfg_loc", "0x%02x",
-		            byte[DDR4_SPD_REG_MODULE_MANUF_LOC]);
+		kv_pair_fmt_int(kv, "mfg_loc",
+				byte[DDR4_SPD_REG_MODULE_MANUF_LOC], "0x%02x",
+				byte[DDR4_SPD_REG_MODULE_MANUF_LOC]);
 		ret = 1;
 		break;
 	}
@@ -177,7 +178,7 @@ int spd_print_field_ddr4(struct platform_intf *intf, struct kv_pair *kv,
 		size /= 4 << (byte[DDR4_SPD_REG_MODULE_ORG] & 0x7);
 		size *= 1 + ((byte[DDR4_SPD_REG_MODULE_ORG] >> 3) & 0x7);
 
-		kv_pair_fmt(kv, "size_mb", "%u", size);
+		kv_pair_add_int(kv, "size_mb", size);
 		ret = 1;
 		break;
 	}
@@ -194,8 +195,8 @@ int spd_print_field_ddr4(struct platform_intf *intf, struct kv_pair *kv,
 
 	case SPD_GET_RANKS:
 	{
-		kv_pair_fmt(kv, "ranks", "%d",
-		            1 + ((byte[DDR4_SPD_REG_MODULE_ORG] >> 3) & 0x7));
+		kv_pair_add_int(kv, "ranks",
+				1 + ((byte[DDR4_SPD_REG_MODULE_ORG] >> 3) & 0x7));
 		ret = 1;
 		break;
 	}
@@ -206,7 +207,7 @@ int spd_print_field_ddr4(struct platform_intf *intf, struct kv_pair *kv,
 		uint8_t width;
 		width = 8 << (byte[DDR4_SPD_REG_MODULE_BUS_WIDTH] & 0x7);
 		width += 8 * ((byte[DDR4_SPD_REG_MODULE_BUS_WIDTH] >> 3) & 0x7);
-		kv_pair_fmt(kv, "width", "%d", width);
+		kv_pair_add_int(kv, "width", width);
 		ret = 1;
 		break;
 	}
@@ -64,6 +64,9 @@ int nonspd_print_field(struct kv_pair *kv,
 {
 	int ret = 0;
 
+	if (!spd_field_wanted(type))
+		return 0;
+
 	switch (type) {
 	case SPD_GET_DRAM_TYPE:
 		switch (info->dram_type) {
@@ -146,7 +149,8 @@ int nonspd_print_field(struct kv_pair *kv,
 
 	case SPD_GET_MFG_LOC:
 	{
-		kv_pair_fmt(kv, "mfg_loc", "0x%02x", info->mfg_loc);
+		kv_pair_fmt_int(kv, "mfg_loc", info->mfg_loc, "0x%02x",
+				info->mfg_loc);
 		ret = 1;
 		break;
 	}
@@ -185,21 +189,21 @@ int nonspd_print_field(struct kv_pair *kv,
 	case SPD_GET_SIZE:
 	{
 		/* translate mbits to mbytes */
-		kv_pair_fmt(kv, "size_mb", "%u", info->module_size_mbits / 8);
+		kv_pair_add_int(kv, "size_mb", info->module_size_mbits / 8);
 		ret = 1;
 		break;
 	}
 
 	case SPD_GET_RANKS:
 	{
-		kv_pair_fmt(kv, "ranks", "%d", info->num_ranks);
+		kv_pair_add_int(kv, "ranks", info->num_ranks);
 		ret = 1;
 		break;
 	}
 
 	case SPD_GET_WIDTH:
 	{
-		kv_pair_fmt(kv, "width", "%d", info->device_width);
+		kv_pair_add_int(kv, "width", info->device_width);
 		ret = 1;
 		break;
 	}
@@ -43,6 +43,7 @@
 #include <errno.h>
 
 #include "mosys/alloc.h"
+#include "mosys/context.h"
 #include "mosys/log.h"
 #include "mosys/platform.h"
 
@@ -163,21 +164,17 @@ int spd_read_i2c(struct platform_intf *intf, int bus,
 	return -1;
 }
 
-/* new_spd_device() - create a new instance of spd_device
+/* read_spd_device() - read the SPD of a DIMM
  *
  * @intf:  platform_intf for access
  * @dimm:  Google logical dimm number to represent
  *
  * returns allocated and filled in spd_devices on success, NULL if error
  */
-struct spd_device *new_spd_device(struct platform_intf *intf, int dimm)
+static struct spd_device *read_spd_device(struct platform_intf *intf, int dimm)
 {
 	struct spd_device *spd;
 
-	if (intf == NULL || dimm < 0) {
-		return NULL;
-	}
-
 	spd = mosys_malloc(sizeof(*spd));
 	spd->dimm_num = dimm;
 	memset(&spd->eeprom.data[0], 0xff, SPD_MAX_LENGTH);
@@ -214,6 +211,52 @@ struct spd_device *new_spd_device(struct platform_intf *intf, int dimm)
 	return spd;
 }
 
+/* new_spd_device() - create a new instance of spd_device
+ *
+ * @intf:  platform_intf for access
+ * @dimm:  Google logical dimm number to represent
+ *
+ * Each DIMM is read once per context, so that printing several fields
+ * of it ("memory spd print all") does not read the EEPROM each time.
+ *
+ * returns allocated and filled in spd_devices on success, NULL if error
+ */
+struct spd_device *new_spd_device(struct platform_intf *intf, int dimm)
+{
+	struct mosys_ctx *ctx = mosys_ctx_get();
+	struct spd_device *spd;
+
+	if (intf == NULL || dimm < 0) {
+		return NULL;
+	}
+
+	if (dimm >= ctx->spd_device_num) {
+		ctx->spd_devices = mosys_realloc(ctx->spd_devices,
+					(dimm + 1) * sizeof(*ctx->spd_devices));
+		memset(&ctx->spd_devices[ctx->spd_device_num], 0,
+		       (dimm + 1 - ctx->spd_device_num) *
+		       sizeof(*ctx->spd_devices));
+		ctx->spd_device_num = dimm + 1;
+	}
+
+	if (!ctx->spd_devices[dimm]) {
+		spd = read_spd_device(intf, dimm);
+		if (!spd) {
+			/* remember that the slot is empty */
+			spd = mosys_zalloc(sizeof(*spd));
+			spd->dimm_num = dimm;
+		}
+		ctx->spd_devices[dimm] = spd;
+	}
+
+	if (!ctx->spd_devices[dimm]->eeprom.length)
+		return NULL;
+
+	spd = mosys_malloc(sizeof(*spd));
+	memcpy(spd, ctx->spd_devices[dimm], sizeof(*spd));
+	return spd;
+}
+
 enum {
 	SPD_INFO_DDR4,
 	SPD_INFO_DEFAULT,
@@ -355,9 +398,11 @@ int spd_read_from_cbfs(struct platform_intf *intf,
 int spd_read_cbfs_flashrom(struct platform_intf *intf, int dimm,
 			   int reg, int spd_len, uint8_t *spd_buf)
 {
-	/* TODO(crbug.com/1018847): Fix memory leak of fw_buf */
-	static uint8_t *fw_buf;
-	static int fw_size;
+	/*
+	 * The image is kept, and freed, with the current context.
+	 * TODO(crbug.com/1018847): The default context never frees it.
+	 */
+	struct mosys_ctx *ctx = mosys_ctx_get();
 
 	/* dimm count is 0 based */
 	if (dimm >= intf->cb->memory->dimm_count(intf)) {
@@ -365,15 +410,16 @@ int spd_read_cbfs_flashrom(struct platform_intf *intf, int dimm,
 		return -1;
 	}
 	/* previous attempt failed */
-	if (fw_size < 0)
+	if (ctx->fw_size < 0)
 		return -1;
 
-	if (!fw_size) {
-		fw_size = flashrom_read_host_firmware_region(intf, &fw_buf);
-		if (fw_size < 0)
+	if (!ctx->fw_size) {
+		ctx->fw_size = flashrom_read_host_firmware_region(
+			intf, mosys_ctx_arena(), &ctx->fw_buf);
+		if (ctx->fw_size < 0)
 			return -1;
 	}
 
 	return spd_read_from_cbfs(intf, dimm, reg,
-				  spd_len, spd_buf, fw_size, fw_buf);
+				  spd_len, spd_buf, ctx->fw_size, ctx->fw_buf);
 }
@@ -107,15 +107,42 @@ int spd_total_size(uint8_t *data)
  */
 int spd_print_raw(struct kv_pair *kv, int len, uint8_t *spd_data)
 {
-	char *str;
+	char str[SPD_MAX_LENGTH * 2 + 1];
 
-	str = buf2str(spd_data, len);
-	kv_pair_fmt(kv, "raw_spd", str);
-	free(str);
+	if (len < 0 || len > SPD_MAX_LENGTH)
+		return -1;
+
+	*hex_encode(str, spd_data, len) = '\0';
+	kv_pair_add(kv, "raw_spd", str);
 
 	return 0;
 }
 
+static const char *const spd_field_keys[] = {
+	[SPD_GET_DRAM_TYPE]	= "dram",
+	[SPD_GET_MODULE_TYPE]	= "module",
+	[SPD_GET_MFG_ID]	= "module_mfg",
+	[SPD_GET_MFG_ID_DRAM]	= "dram_mfg",
+	[SPD_GET_MFG_LOC]	= "mfg_loc",
+	[SPD_GET_MFG_DATE]	= "mfg_date",
+	[SPD_GET_PART_NUMBER]	= "part_number",
+	[SPD_GET_REVISION_CODE]	= "revision_code",
+	[SPD_GET_SIZE]		= "size_mb",
+	[SPD_GET_ECC]		= "ecc",
+	[SPD_GET_RANKS]		= "ranks",
+	[SPD_GET_WIDTH]		= "width",
+	[SPD_GET_CHECKSUM]	= "checksum",
+	[SPD_GET_SPEEDS]	= "speeds",
+};
+
+int spd_field_wanted(enum spd_field_type type)
+{
+	if (type >= ARRAY_SIZE(spd_field_keys))
+		return 1;
+
+	return kv_key_wanted(spd_field_keys[type]);
+}
+
 /*
  * spd_print_field  -  add common SPD fields into key=value pair
  *
@@ -138,6 +165,9 @@ int spd_print_field(struct platform_intf *intf,
 	if (!intf || !kv || !data)
 		return -1;
 
+	if (!spd_field_wanted(type))
+		return 0;
+
 	switch (byte[2]) {
 	case SPD_DRAM_TYPE_DDR3:
 	case SPD_DRAM_TYPE_LPDDR3:
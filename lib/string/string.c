@@ -45,6 +45,37 @@
 
 #include "lib/string.h"
 
+/* the two hex digits of each byte value */
+static const char hex_pairs[256 * 2 + 1] =
+	"000102030405060708090a0b0c0d0e0f"
+	"101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f"
+	"303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f"
+	"505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f"
+	"707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f"
+	"909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+	"b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+	"d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+	"f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+char *hex_encode(char *dst, const uint8_t *src, size_t length)
+{
+	size_t i;
+
+	for (i = 0; i < length; i++) {
+		memcpy(dst, &hex_pairs[src[i] * 2], 2);
+		dst += 2;
+	}
+
+	return dst;
+}
+
 /*
  * buf2str  -  represent an array of bytes as a hex string (no prefix)
  *
@@ -56,23 +87,13 @@
  */
 char *buf2str(uint8_t *inbuf, size_t length)
 {
-	size_t i;
 	char *outbuf;
-	char *outp;
 
 	if (inbuf == NULL)
 		return NULL;
 
 	outbuf = mosys_malloc(2*length + 1);
-	outp = outbuf;
-
-	for (i = 0; i < length; i++) {
-		/* sprintf includes the NUL terminator */
-		sprintf(outp, "%02x", inbuf[i]);
-		outp += 2;
-	}
-
-	outbuf[2*length] = '\0';
+	*hex_encode(outbuf, inbuf, length) = '\0';
 	return outbuf;
 }
 
@@ -28,7 +28,9 @@
 
 #include "lib/vpd.h"
 #include "mosys/alloc.h"
+#include "mosys/counters.h"
 #include "mosys/log.h"
+#include "mosys/trace.h"
 
 char *vpd_get_value(const char *name)
 {
@@ -41,6 +43,7 @@ char *vpd_get_value(const char *name)
 	pid_t pid;
 	const char *const argv[] = { "/usr/sbin/vpd_get_value", name, NULL };
 	char *const env[] = { NULL };
+	TRACE_SCOPE("exec", argv[0]);
 
 	if (pipe(pipefd) < 0) {
 		lprintf(LOG_ERR, "%s: pipe() failed: %s\n", __func__,
@@ -70,6 +73,7 @@ char *vpd_get_value(const char *name)
 		exit(1);
 	}
 
+	counter_add(COUNTER_CHILD_PROCS, 1);
 	close(pipefd[1]);
 	if (waitpid(pid, &wstatus, 0) < 0) {
 		lprintf(LOG_ERR, "%s: waitpid() failed: %s\n", __func__,
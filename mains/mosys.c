@@ -6,16 +6,61 @@
 #include <chromeos/libminijail.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <linux/filter.h>
 #include <linux/securebits.h>
+#include <stdlib.h>
 #include <sys/capability.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "mosys/alloc.h"
 #include "mosys/cli.h"
+#include "mosys/daemon.h"
+#include "mosys/trace.h"
 
 #define MOSYS_CAPS CAP_TO_MASK(CAP_SYS_RAWIO) | CAP_TO_MASK(CAP_SYS_ADMIN)
 #define MOSYS_SECCOMP_POLICY_PATH "/usr/share/policy/mosys-seccomp.policy"
+#define MOSYS_SECCOMP_BPF_PATH "/usr/share/policy/mosys-seccomp.policy.bpf"
+
+/*
+ * Load the seccomp filter compiled from the policy at build time.
+ *
+ * Returns 0 if the filter was set, or -1 if there is no usable compiled
+ * filter and the text policy has to be parsed instead.
+ */
+static int load_seccomp_bpf(struct minijail *j)
+{
+	struct sock_fprog prog;
+	struct stat st;
+	ssize_t len;
+	int fd;
+
+	fd = open(MOSYS_SECCOMP_BPF_PATH, O_RDONLY);
+	if (fd < 0)
+		return -1;
+
+	if (fstat(fd, &st) < 0 || st.st_size <= 0 ||
+	    st.st_size % sizeof(struct sock_filter) ||
+	    st.st_size / sizeof(struct sock_filter) > BPF_MAXINSNS) {
+		close(fd);
+		return -1;
+	}
+
+	prog.len = st.st_size / sizeof(struct sock_filter);
+	prog.filter = mosys_malloc(st.st_size);
+	len = read(fd, prog.filter, st.st_size);
+	close(fd);
+	if (len != st.st_size) {
+		free(prog.filter);
+		return -1;
+	}
+
+	/* minijail keeps its own copy of the filter */
+	minijail_set_seccomp_filters(j, &prog);
+	free(prog.filter);
+	return 0;
+}
 
 static void setup_jail(void)
 {
@@ -43,13 +88,18 @@ static void setup_jail(void)
 	minijail_no_new_privs(j);
 	minijail_set_seccomp_filter_tsync(j);
 
-	/* This file is expected to not be present in initramfs.  Only
-	   set the seccomp policy when it exists. */
-	fd = open(MOSYS_SECCOMP_POLICY_PATH, O_RDONLY);
-	if (fd >= 0) {
-		minijail_parse_seccomp_filters_from_fd(j, fd);
+	/* These files are expected to not be present in initramfs.  Only
+	   set the seccomp policy when one exists, preferring the one
+	   compiled at build time over parsing the text policy. */
+	if (load_seccomp_bpf(j) == 0) {
 		minijail_use_seccomp_filter(j);
-		close(fd);
+	} else {
+		fd = open(MOSYS_SECCOMP_POLICY_PATH, O_RDONLY);
+		if (fd >= 0) {
+			minijail_parse_seccomp_filters_from_fd(j, fd);
+			minijail_use_seccomp_filter(j);
+			close(fd);
+		}
 	}
 
 	minijail_enter(j);
@@ -58,6 +108,20 @@ static void setup_jail(void)
 
 int main(int argc, char *argv[])
 {
+	const char *sock = getenv(MOSYSD_SOCKET_ENV);
+	uint64_t start;
+
+	/* Let a running daemon answer, if there is one. */
+	if (sock && *sock) {
+		int rc = mosys_daemon_request(sock, argc, argv);
+
+		if (rc >= 0)
+			return rc;
+	}
+
+	start = trace_now();
 	setup_jail();
+	trace_add_early("jail", "setup_jail", start, trace_now());
+
 	return mosys_main(argc, argv);
 }
@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# Compare the time mosys spends printing records with "-k" against "-j",
+# as reported by mosys -T, e.g. on a DUT with a full eventlog:
+#
+#   ./output_benchmark.sh 20 mosys eventlog list
+
+RUNS="${1:-20}"
+shift
+CMD=("${@:-mosys}")
+
+# Print the average total kv_pair_print time in ms for the given style.
+average_output_ms() {
+  local style="$1"
+  local i
+  for ((i = 0; i < RUNS; i++)); do
+    "${CMD[0]}" -T "${style}" "${CMD[@]:1}" 2>&1 >/dev/null
+  done | awk '$1 == "output" && $2 == "kv_pair_print" { sum += $4; n++ }
+    END { if (n) printf "%.3f\n", sum / n }'
+}
+
+pair_ms=$(average_output_ms -k)
+json_ms=$(average_output_ms -j)
+
+echo "runs:          ${RUNS}"
+echo "key=value:     ${pair_ms} ms"
+echo "JSON:          ${json_ms} ms"
+awk -v p="${pair_ms}" -v j="${json_ms}" \
+  'BEGIN { if (p > 0) printf "ratio:         %.2f\n", j / p }'
@@ -76,6 +76,7 @@ static struct platform_cmd *gru_sub[] = {
 	&cmd_platform,
 	&cmd_psu,
 	&cmd_eventlog,
+	&cmd_snapshot,
 	NULL
 };
 
@@ -120,6 +121,7 @@ static struct eventlog_cb gru_eventlog_cb = {
 	.print_type	= &elog_print_type,
 	.print_data	= &elog_print_data,
 	.print_multi	= &elog_print_multi,
+	.count_multi	= &elog_count_multi,
 	.verify		= &elog_verify,
 	.verify_header	= &elog_verify_header,
 	.add		= &elog_add_event_manually,
@@ -55,6 +55,7 @@ static struct platform_cmd *kukui_sub[] = {
 	&cmd_platform,
 	&cmd_psu,
 	&cmd_eventlog,
+	&cmd_snapshot,
 	NULL
 };
 
@@ -67,6 +68,7 @@ static struct eventlog_cb kukui_eventlog_cb = {
 	.print_type	= &elog_print_type,
 	.print_data	= &elog_print_data,
 	.print_multi	= &elog_print_multi,
+	.count_multi	= &elog_count_multi,
 	.verify		= &elog_verify,
 	.verify_header	= &elog_verify_header,
 	.add		= &elog_add_event_manually,
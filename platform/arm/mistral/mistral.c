@@ -57,6 +57,7 @@ static struct platform_cmd *mistral_sub[] = {
 	&cmd_memory,
 	&cmd_platform,
 	&cmd_eventlog,
+	&cmd_snapshot,
 	NULL
 };
 
@@ -77,6 +78,7 @@ static struct eventlog_cb mistral_eventlog_cb = {
 	.print_type	= &elog_print_type,
 	.print_data	= &elog_print_data,
 	.print_multi	= &elog_print_multi,
+	.count_multi	= &elog_count_multi,
 	.verify		= &elog_verify,
 	.verify_header	= &elog_verify_header,
 	.add		= &elog_add_event_manually,
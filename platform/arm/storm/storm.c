@@ -60,6 +60,7 @@ static struct platform_cmd *storm_sub[] = {
 	&cmd_memory,
 	&cmd_platform,
 	&cmd_eventlog,
+	&cmd_snapshot,
 	NULL
 };
 
@@ -87,6 +88,7 @@ static struct eventlog_cb storm_eventlog_cb = {
 	.print_type	= &elog_print_type,
 	.print_data	= &elog_print_data,
 	.print_multi	= &elog_print_multi,
+	.count_multi	= &elog_count_multi,
 	.verify		= &elog_verify,
 	.verify_header	= &elog_verify_header,
 	.add		= &elog_add_event_manually,
@@ -78,6 +78,7 @@ static struct platform_cmd *glados_sub[] = {
 	&cmd_pd,
 	&cmd_platform,
 	&cmd_eventlog,
+	&cmd_snapshot,
 	NULL
 };
 
@@ -112,6 +113,7 @@ static struct eventlog_cb glados_eventlog_cb = {
 	.print_type	= &elog_print_type,
 	.print_data	= &elog_print_data,
 	.print_multi	= &elog_print_multi,
+	.count_multi	= &elog_count_multi,
 	.verify		= &elog_verify,
 	.verify_header	= &elog_verify_header,
 	.fetch		= &elog_fetch_from_smbios,
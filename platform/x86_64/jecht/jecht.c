@@ -19,6 +19,7 @@ static struct platform_cmd *jecht_sub[] = {
 	&cmd_memory,
 	&cmd_platform,
 	&cmd_psu,
+	&cmd_snapshot,
 	NULL,
 };
 
@@ -54,6 +55,7 @@ static struct eventlog_cb jecht_eventlog_cb = {
 	.print_type = &elog_print_type,
 	.print_data = &elog_print_data,
 	.print_multi = &elog_print_multi,
+	.count_multi = &elog_count_multi,
 	.verify = &elog_verify,
 	.verify_header = &elog_verify_header,
 	.fetch = &elog_fetch_from_smbios,
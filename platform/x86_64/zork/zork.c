@@ -24,6 +24,7 @@ static struct platform_cmd *zork_sub[] = {
 	&cmd_pd,
 	&cmd_platform,
 	&cmd_eventlog,
+	&cmd_snapshot,
 	NULL,
 };
 
@@ -37,6 +38,7 @@ static struct eventlog_cb zork_eventlog_cb = {
 	.print_type = &elog_print_type,
 	.print_data = &elog_print_data,
 	.print_multi = &elog_print_multi,
+	.count_multi = &elog_count_multi,
 	.verify = &elog_verify,
 	.verify_header = &elog_verify_header,
 	.fetch = &elog_fetch_from_smbios,
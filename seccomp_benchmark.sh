@@ -0,0 +1,41 @@
+#!/bin/bash
+
+# Compare the time mosys spends setting up its minijail when loading the
+# seccomp filter compiled at build time against parsing the text policy.
+# Must be run as root on a DUT with both policies installed, e.g.:
+#
+#   ./seccomp_benchmark.sh 100 mosys platform name
+#
+# The compiled filter is hidden for the second pass by bind-mounting an
+# empty file over it, which makes mosys fall back to the text policy.
+
+BPF=/usr/share/policy/mosys-seccomp.policy.bpf
+RUNS="${1:-100}"
+shift
+CMD=("${@:-mosys}")
+
+if [[ ! -f "${BPF}" ]]; then
+  echo "${BPF} is not installed" >&2
+  exit 1
+fi
+
+# Print the average setup_jail time in ms, as reported by mosys -T.
+average_jail_ms() {
+  local i
+  for ((i = 0; i < RUNS; i++)); do
+    "${CMD[0]}" -T "${CMD[@]:1}" 2>&1 >/dev/null
+  done | awk '$1 == "jail" && $2 == "setup_jail" { sum += $4; n++ }
+    END { if (n) printf "%.3f\n", sum / n }'
+}
+
+bpf_ms=$(average_jail_ms)
+
+trap 'umount "${BPF}"' EXIT
+mount --bind /dev/null "${BPF}" || exit 1
+text_ms=$(average_jail_ms)
+
+echo "runs:          ${RUNS}"
+echo "compiled BPF:  ${bpf_ms} ms"
+echo "text policy:   ${text_ms} ms"
+awk -v b="${bpf_ms}" -v t="${text_ms}" \
+  'BEGIN { printf "saved:         %.3f ms per run\n", t - b }'